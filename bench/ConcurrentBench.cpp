@@ -0,0 +1,132 @@
+// Throughput of ConcurrentHashMap against a HashMap behind one global mutex,
+// for 1 to 64 threads running a 90% find / 10% insert-or-remove mix.
+//
+//   g++ -std=c++17 -O2 -pthread bench/ConcurrentBench.cpp -o concurrent_bench
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/ConcurrentHashMap.h"
+#include "../include/HashMap.h"
+
+namespace
+{
+  const int KEY_SPACE = 1 << 20;
+  const int OPS_PER_THREAD = 1 << 20;
+
+  class GlobalLockMap
+  {
+  public:
+    bool find(int key, int& value)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto pair_it = map_.find(key);
+      if (pair_it == map_.end())
+      {
+        return false;
+      }
+      value = pair_it->second;
+      return true;
+    }
+
+    void insert(int key, int value)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      map_.insert(key, value);
+    }
+
+    void remove(int key)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      map_.remove(key);
+    }
+
+  private:
+    std::mutex mutex_;
+    HashMap<int, int> map_;
+  };
+
+  class ShardedMap
+  {
+  public:
+    ShardedMap() : map_(64) {}
+
+    bool find(int key, int& value) { return map_.find(key, value); }
+    void insert(int key, int value) { map_.insert(key, value); }
+    void remove(int key) { map_.remove(key); }
+
+  private:
+    ConcurrentHashMap<int, int> map_;
+  };
+
+  // Returns millions of operations per second.
+  template <class Map>
+  double measure(Map& map, int threadCount)
+  {
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int t = 0; t < threadCount; t++)
+    {
+      threads.emplace_back([&map, t]()
+      {
+        std::mt19937 rng(t);
+        std::uniform_int_distribution<int> keys(0, KEY_SPACE - 1);
+        int value = 0;
+        for (int i = 0; i < OPS_PER_THREAD; i++)
+        {
+          int key = keys(rng);
+          int op = i % 20;
+          if (op == 0)
+          {
+            map.insert(key, key);
+          }
+          else if (op == 1)
+          {
+            map.remove(key);
+          }
+          else
+          {
+            map.find(key, value);
+          }
+        }
+      });
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(threadCount) * OPS_PER_THREAD / elapsed / 1e6;
+  }
+
+  template <class Map>
+  void preload(Map& map)
+  {
+    for (int key = 0; key < KEY_SPACE; key += 2)
+    {
+      map.insert(key, key);
+    }
+  }
+}
+
+int main()
+{
+  std::printf("%8s %16s %16s\n", "threads", "global mutex", "sharded");
+  for (int threadCount = 1; threadCount <= 64; threadCount *= 2)
+  {
+    GlobalLockMap global;
+    ShardedMap sharded;
+    preload(global);
+    preload(sharded);
+
+    double before = measure(global, threadCount);
+    double after = measure(sharded, threadCount);
+    std::printf("%8d %10.1f Mop/s %10.1f Mop/s\n", threadCount, before, after);
+  }
+  return 0;
+}
@@ -0,0 +1,112 @@
+// Lookup cost of findBatch against one find() per key, for batch sizes 1 to
+// 1024 on tables well beyond the last-level cache, with 64-bit and with
+// string keys. The table size can be given as the first argument (number of
+// entries, default 4M).
+//
+//   g++ -std=c++17 -O2 bench/FindBatchBench.cpp -o find_batch_bench
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/FlatHashMap.h"
+#include "../include/Hash.h"
+#include "../include/HashMap.h"
+
+namespace
+{
+  const std::size_t LOOKUPS = 1 << 22;
+
+  using StringMap = HashMap<std::string, std::uint64_t, detail::StringHash>;
+
+  // Key number i: a scrambled integer, or a short string that stays inside
+  // the node like most dictionary words do.
+  template <class Key>
+  Key makeKey(std::uint64_t i);
+
+  template <>
+  std::uint64_t makeKey<std::uint64_t>(std::uint64_t i)
+  {
+    return i * 0x9E3779B97F4A7C15ull;
+  }
+
+  template <>
+  std::string makeKey<std::string>(std::uint64_t i)
+  {
+    return "word" + std::to_string(i);
+  }
+
+  // Returns nanoseconds per lookup. sink collects the results so no lookup
+  // can be optimised away.
+  template <class Map, class Key, class Lookup>
+  double measure(Map& map, const std::vector<Key>& keys, std::size_t batchSize, Lookup lookup, std::uint64_t& sink)
+  {
+    std::vector<typename Map::iterator> results(batchSize, map.end());
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t offset = 0; offset + batchSize <= keys.size(); offset += batchSize)
+    {
+      lookup(map, keys.data() + offset, batchSize, results.data());
+      for (std::size_t i = 0; i < batchSize; i++)
+      {
+        sink += results[i] != map.end() ? results[i]->second : 0;
+      }
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(keys.size() / batchSize * batchSize);
+  }
+
+  template <class Map, class Key = std::uint64_t>
+  void run(const char* name, std::size_t entries)
+  {
+    Map map;
+    map.rehash(entries);
+    for (std::uint64_t key = 0; key < entries; key++)
+    {
+      map.insert(makeKey<Key>(key), key);
+    }
+
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<std::uint64_t> pick(0, entries * 2);
+    std::vector<Key> keys(LOOKUPS);
+    for (Key& key : keys)
+    {
+      key = makeKey<Key>(pick(rng));
+    }
+
+    auto single = [](Map& m, const Key* batch, std::size_t count, typename Map::iterator* out)
+    {
+      for (std::size_t i = 0; i < count; i++)
+      {
+        out[i] = m.find(batch[i]);
+      }
+    };
+    auto batched = [](Map& m, const Key* batch, std::size_t count, typename Map::iterator* out)
+    {
+      m.findBatch(batch, batch + count, out);
+    };
+
+    std::uint64_t sink = 0;
+    std::printf("%s, %zu entries\n%8s %14s %14s %8s\n", name, entries, "batch", "find", "findBatch", "speedup");
+    for (std::size_t batchSize = 1; batchSize <= 1024; batchSize *= 2)
+    {
+      double before = measure(map, keys, batchSize, single, sink);
+      double after = measure(map, keys, batchSize, batched, sink);
+      std::printf("%8zu %11.1f ns %11.1f ns %7.2fx\n", batchSize, before, after, before / after);
+    }
+    std::printf("(checksum %llx)\n\n", static_cast<unsigned long long>(sink));
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t entries = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 22;
+  run<HashMap<std::uint64_t, std::uint64_t>>("chained", entries);
+  run<HashMap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, detail::FlatStorage>>("flat", entries);
+  run<StringMap, std::string>("chained, string keys", entries);
+  return 0;
+}
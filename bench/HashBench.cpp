@@ -0,0 +1,77 @@
+// Throughput of detail::StringHash against the previous Jenkins
+// one-at-a-time hash for a range of key lengths.
+//
+//   g++ -std=c++17 -O2 bench/HashBench.cpp src/Hash.cpp -o hash_bench
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Hash.h"
+
+namespace
+{
+  const std::size_t KEY_COUNT = 1024;
+  const std::size_t TARGET_BYTES = 64 * 1024 * 1024;
+
+  std::vector<std::string> makeKeys(std::size_t length)
+  {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::vector<std::string> keys(KEY_COUNT);
+    for (std::string& key : keys)
+    {
+      key.resize(length);
+      for (char& c : key)
+      {
+        c = static_cast<char>(letter(rng));
+      }
+    }
+    return keys;
+  }
+
+  // Returns the throughput in MB/s; the accumulated hash is written to sink
+  // so the calls cannot be optimised away.
+  template <class Hasher>
+  double measure(const std::vector<std::string>& keys, std::size_t& sink)
+  {
+    Hasher hasher;
+    std::size_t rounds = TARGET_BYTES / (keys.size() * keys.front().size()) + 1;
+    std::size_t total = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t round = 0; round < rounds; ++round)
+    {
+      for (const std::string& key : keys)
+      {
+        total += hasher(key);
+      }
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    sink ^= total;
+    double bytes = static_cast<double>(rounds * keys.size() * keys.front().size());
+    return bytes / elapsed / (1024.0 * 1024.0);
+  }
+}
+
+int main()
+{
+  const std::size_t lengths[] = { 4, 8, 12, 16, 24, 32, 48, 64, 96, 128, 192, 256 };
+  std::size_t sink = 0;
+
+  std::printf("%8s %16s %16s %8s\n", "bytes", "one-at-a-time", "StringHash", "speedup");
+  for (std::size_t length : lengths)
+  {
+    std::vector<std::string> keys = makeKeys(length);
+    double before = measure<detail::OneAtATimeHash>(keys, sink);
+    double after = measure<detail::StringHash>(keys, sink);
+    std::printf("%8zu %11.0f MB/s %11.0f MB/s %7.1fx\n", length, before, after, after / before);
+  }
+
+  std::printf("(checksum %zx)\n", sink);
+  return 0;
+}
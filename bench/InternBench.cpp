@@ -0,0 +1,120 @@
+// Heap usage and lookup cost of Dictionary against InternedDictionary on a
+// synthetic vocabulary where translations repeat across words. The number of
+// words can be given as the first argument (default 1M).
+//
+//   cmake --build build --target intern_bench && build/intern_bench 1000000
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Dictionary.h"
+#include "../include/InternedDictionary.h"
+
+namespace
+{
+  const std::size_t TRANSLATION_VOCABULARY = 50000;
+  const std::size_t LOOKUPS = 1 << 21;
+
+  // Every allocation carries its size in front so the live total can be
+  // tracked without the library's help.
+  std::size_t liveBytes = 0;
+  const std::size_t HEADER = alignof(std::max_align_t);
+
+  struct Pair
+  {
+    std::string first;
+    std::string second;
+  };
+
+  template <class Dict, class Lookup>
+  void run(const char* name, const std::vector<Pair>& pairs, const std::vector<std::string>& keys, Lookup lookup)
+  {
+    std::size_t before = liveBytes;
+    auto start = std::chrono::steady_clock::now();
+    Dict* dict = new Dict();
+    for (const Pair& pair : pairs)
+    {
+      dict->insert(pair.first, pair.second);
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::size_t bytes = liveBytes - before;
+
+    std::size_t sink = 0;
+    start = std::chrono::steady_clock::now();
+    for (const std::string& key : keys)
+    {
+      sink += lookup(*dict, key);
+    }
+    double lookupNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+      / static_cast<double>(keys.size());
+
+    std::printf("%-20s %10.1f MB %9.2f s load %8.1f ns/lookup (checksum %zu)\n",
+      name, static_cast<double>(bytes) / (1024.0 * 1024.0), loadSeconds, lookupNs, sink);
+    delete dict;
+  }
+}
+
+void* operator new(std::size_t size)
+{
+  char* block = static_cast<char*>(std::malloc(size + HEADER));
+  if (block == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<std::size_t*>(block) = size;
+  liveBytes += size;
+  return block + HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr != nullptr)
+  {
+    char* block = static_cast<char*>(ptr) - HEADER;
+    liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+  }
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t words = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  std::mt19937_64 rng(11);
+  std::uniform_int_distribution<std::size_t> pickTranslation(0, TRANSLATION_VOCABULARY - 1);
+  std::uniform_int_distribution<std::size_t> pickCount(1, 4);
+  std::vector<Pair> pairs;
+  for (std::size_t i = 0; i < words; i++)
+  {
+    std::string word = "dictionary headword " + std::to_string(i);
+    for (std::size_t count = pickCount(rng); count > 0; count--)
+    {
+      pairs.push_back(Pair{ word, "a common translation " + std::to_string(pickTranslation(rng)) });
+    }
+  }
+
+  std::uniform_int_distribution<std::size_t> pickWord(0, words - 1);
+  std::vector<std::string> keys(LOOKUPS);
+  for (std::string& key : keys)
+  {
+    key = "dictionary headword " + std::to_string(pickWord(rng));
+  }
+
+  std::printf("%zu words, %zu pairs\n", words, pairs.size());
+  run<Dictionary>("Dictionary", pairs, keys,
+    [](Dictionary& dict, const std::string& key) { return dict.find(key)->second.size(); });
+  run<InternedDictionary>("InternedDictionary", pairs, keys,
+    [](InternedDictionary& dict, const std::string& key) { return dict.find(key).size(); });
+  return 0;
+}
@@ -0,0 +1,319 @@
+// Throughput, latency and memory of HashMap (chained, flat and dense) against
+// std::unordered_map: insert, hit and miss lookup, remove, iteration and
+// rehash of 64-bit keys, plus Dictionary loading, each with uniform and
+// Zipfian key popularity. The arguments are the table sizes to run (default
+// 1K, 10K, 100K and 1M); sizes up to 100M work given the memory.
+//
+// Every LATENCY_STRIDE-th operation is timed on its own for the p50/p99
+// columns, which adds a few percent to the throughput figures. Bytes per
+// entry is the heap growth while the table was built, divided by its size.
+//
+//   cmake --build build --target map_bench && build/map_bench 1000 1000000
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../include/DenseHashMap.h"
+#include "../include/Dictionary.h"
+#include "../include/FlatHashMap.h"
+#include "../include/HashMap.h"
+
+namespace
+{
+  const std::size_t LATENCY_STRIDE = 16;
+  const std::size_t DICTIONARY_VOCABULARY = 1000;
+  const double ZIPF_THETA = 0.99;
+
+  std::size_t liveBytes = 0;
+  const std::size_t HEADER = alignof(std::max_align_t);
+
+  using ChainedMap = HashMap<std::uint64_t, std::uint64_t>;
+  using FlatMap = HashMap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, detail::FlatStorage>;
+  using DenseMap = HashMap<std::uint64_t, std::uint64_t, std::hash<std::uint64_t>, detail::DenseStorage>;
+  using StdMap = std::unordered_map<std::uint64_t, std::uint64_t>;
+  using StdDictionary = std::unordered_map<std::string, std::set<std::string>>;
+
+  struct Result
+  {
+    double opsPerSecond;
+    double p50;
+    double p99;
+  };
+
+  std::uint64_t mix(std::uint64_t x)
+  {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  // Gray et al., "Quickly generating billion-record synthetic databases":
+  // ranks in [0, n) where rank 0 is the most popular.
+  class ZipfDistribution
+  {
+  public:
+    explicit ZipfDistribution(std::size_t n) : n_(n)
+    {
+      double zeta2 = 1.0 + std::pow(0.5, ZIPF_THETA);
+      for (std::size_t i = 1; i <= n; i++)
+      {
+        zetaN_ += 1.0 / std::pow(static_cast<double>(i), ZIPF_THETA);
+      }
+      alpha_ = 1.0 / (1.0 - ZIPF_THETA);
+      eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - ZIPF_THETA)) / (1.0 - zeta2 / zetaN_);
+      threshold_ = 1.0 + std::pow(0.5, ZIPF_THETA);
+    }
+
+    template <class Rng>
+    std::size_t operator()(Rng& rng)
+    {
+      double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+      double uz = u * zetaN_;
+      if (uz < 1.0)
+      {
+        return 0;
+      }
+      if (uz < threshold_)
+      {
+        return n_ > 1 ? 1 : 0;
+      }
+      std::size_t rank = static_cast<std::size_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_));
+      return std::min(rank, n_ - 1);
+    }
+
+  private:
+    std::size_t n_;
+    double zetaN_ = 0;
+    double alpha_;
+    double eta_;
+    double threshold_;
+  };
+
+  // Indices into a key array of the given size, drawn uniformly or by Zipf.
+  std::vector<std::size_t> makeStream(std::size_t size, std::size_t count, bool zipf, std::uint64_t seed)
+  {
+    std::mt19937_64 rng(seed);
+    std::vector<std::size_t> stream(count);
+    if (zipf)
+    {
+      ZipfDistribution pick(size);
+      std::generate(stream.begin(), stream.end(), [&]() { return pick(rng); });
+    }
+    else
+    {
+      std::uniform_int_distribution<std::size_t> pick(0, size - 1);
+      std::generate(stream.begin(), stream.end(), [&]() { return pick(rng); });
+    }
+    return stream;
+  }
+
+  // Runs op(0) ... op(count - 1), timing every LATENCY_STRIDE-th call alone.
+  template <class Op>
+  Result measure(std::size_t count, Op op)
+  {
+    using Clock = std::chrono::steady_clock;
+    std::vector<double> samples;
+    samples.reserve(count / LATENCY_STRIDE + 1);
+
+    Clock::time_point start = Clock::now();
+    for (std::size_t i = 0; i < count; i++)
+    {
+      if (i % LATENCY_STRIDE == 0)
+      {
+        Clock::time_point before = Clock::now();
+        op(i);
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+      }
+      else
+      {
+        op(i);
+      }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result result = { static_cast<double>(count) / seconds, 0, 0 };
+    if (!samples.empty())
+    {
+      std::sort(samples.begin(), samples.end());
+      result.p50 = samples[samples.size() / 2];
+      result.p99 = samples[std::min(samples.size() - 1, samples.size() * 99 / 100)];
+    }
+    return result;
+  }
+
+  void report(const char* map, const char* workload, const char* keys, std::size_t size, const Result& result,
+    double bytesPerEntry = 0)
+  {
+    std::printf("%-20s %-10s %-8s %10zu %10.2f %9.1f %9.1f %9.1f\n", map, workload, keys, size,
+      result.opsPerSecond / 1e6, result.p50, result.p99, bytesPerEntry);
+  }
+
+  template <class Map>
+  void insertKey(Map& map, std::uint64_t key, std::uint64_t value) { map.insert(key, value); }
+  void insertKey(StdMap& map, std::uint64_t key, std::uint64_t value) { map.insert_or_assign(key, value); }
+
+  template <class Map>
+  bool removeKey(Map& map, std::uint64_t key) { return map.remove(key); }
+  bool removeKey(StdMap& map, std::uint64_t key) { return map.erase(key) != 0; }
+
+  template <class Map>
+  void runMap(const char* name, const char* keys, std::size_t size, bool zipf, std::uint64_t& sink)
+  {
+    std::vector<std::uint64_t> present(size);
+    std::vector<std::uint64_t> missing(size);
+    for (std::size_t i = 0; i < size; i++)
+    {
+      present[i] = mix(i);
+      missing[i] = mix(i + size);
+    }
+    std::vector<std::size_t> stream = makeStream(size, size, zipf, 7);
+
+    std::size_t before = liveBytes;
+    Map* map = new Map();
+    Result insert = measure(size, [&](std::size_t i) { insertKey(*map, present[i], i); });
+    report(name, "insert", keys, size, insert, static_cast<double>(liveBytes - before) / static_cast<double>(size));
+
+    report(name, "hit", keys, size, measure(size, [&](std::size_t i)
+    {
+      sink += map->find(present[stream[i]])->second;
+    }));
+    report(name, "miss", keys, size, measure(size, [&](std::size_t i)
+    {
+      sink += map->find(missing[stream[i]]) == map->end();
+    }));
+
+    Result iterate = measure(1, [&](std::size_t)
+    {
+      for (auto it = map->begin(); it != map->end(); ++it)
+      {
+        sink += it->second;
+      }
+    });
+    iterate.opsPerSecond *= static_cast<double>(size);
+    iterate.p50 = iterate.p99 = 0;
+    report(name, "iterate", keys, size, iterate);
+
+    Result rehash = measure(1, [&](std::size_t) { map->rehash(size * 4); });
+    rehash.opsPerSecond *= static_cast<double>(size);
+    rehash.p50 = rehash.p99 = 0;
+    report(name, "rehash", keys, size, rehash);
+
+    report(name, "remove", keys, size, measure(size, [&](std::size_t i)
+    {
+      sink += removeKey(*map, present[stream[i]]);
+    }));
+    delete map;
+  }
+
+  template <class Dict>
+  void addTranslation(Dict& dict, const std::string& word, const std::string& translation) { dict.insert(word, translation); }
+  void addTranslation(StdDictionary& dict, const std::string& word, const std::string& translation) { dict[word].insert(translation); }
+
+  // size (word, translation) pairs over size distinct words.
+  template <class Dict>
+  void runDictionary(const char* name, const char* keys, std::size_t size, bool zipf,
+    const std::vector<std::string>& words, const std::vector<std::string>& translations)
+  {
+    std::vector<std::size_t> wordStream = makeStream(size, size, zipf, 11);
+    std::vector<std::size_t> translationStream = makeStream(translations.size(), size, false, 13);
+
+    std::size_t before = liveBytes;
+    Dict* dict = new Dict();
+    Result load = measure(size, [&](std::size_t i)
+    {
+      addTranslation(*dict, words[wordStream[i]], translations[translationStream[i]]);
+    });
+    report(name, "load", keys, size, load, static_cast<double>(liveBytes - before) / static_cast<double>(dict->size()));
+    delete dict;
+  }
+}
+
+void* operator new(std::size_t size)
+{
+  char* block = static_cast<char*>(std::malloc(size + HEADER));
+  if (block == nullptr)
+  {
+    throw std::bad_alloc();
+  }
+  *reinterpret_cast<std::size_t*>(block) = size;
+  liveBytes += size;
+  return block + HEADER;
+}
+
+void operator delete(void* ptr) noexcept
+{
+  if (ptr != nullptr)
+  {
+    char* block = static_cast<char*>(ptr) - HEADER;
+    liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+  }
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  operator delete(ptr);
+}
+
+int main(int argc, char** argv)
+{
+  std::vector<std::size_t> sizes;
+  for (int i = 1; i < argc; i++)
+  {
+    sizes.push_back(std::strtoull(argv[i], nullptr, 10));
+  }
+  if (sizes.empty())
+  {
+    sizes = { 1000, 10000, 100000, 1000000 };
+  }
+
+  std::vector<std::string> translations;
+  for (std::size_t i = 0; i < DICTIONARY_VOCABULARY; i++)
+  {
+    translations.push_back("translation" + std::to_string(i));
+  }
+
+  std::uint64_t sink = 0;
+  std::printf("%-20s %-10s %-8s %10s %10s %9s %9s %9s\n", "map", "workload", "keys", "size", "Mops/s", "p50 ns",
+    "p99 ns", "B/entry");
+  for (std::size_t size : sizes)
+  {
+    if (size == 0)
+    {
+      continue;
+    }
+    for (bool zipf : { false, true })
+    {
+      const char* keys = zipf ? "zipf" : "uniform";
+      runMap<ChainedMap>("HashMap", keys, size, zipf, sink);
+      runMap<FlatMap>("HashMap<Flat>", keys, size, zipf, sink);
+      runMap<DenseMap>("HashMap<Dense>", keys, size, zipf, sink);
+      runMap<StdMap>("std::unordered_map", keys, size, zipf, sink);
+
+      std::vector<std::string> words(size);
+      for (std::size_t i = 0; i < size; i++)
+      {
+        words[i] = "word" + std::to_string(mix(i) % (size * 16));
+      }
+      runDictionary<Dictionary>("Dictionary", keys, size, zipf, words, translations);
+      runDictionary<FlatDictionary>("FlatDictionary", keys, size, zipf, words, translations);
+      runDictionary<DenseDictionary>("DenseDictionary", keys, size, zipf, words, translations);
+      runDictionary<StdDictionary>("std::unordered_map", keys, size, zipf, words, translations);
+    }
+  }
+  std::printf("(checksum %llx)\n", static_cast<unsigned long long>(sink));
+  return 0;
+}
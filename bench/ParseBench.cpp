@@ -0,0 +1,74 @@
+// Throughput of the block-reading dictionary parser against the previous
+// std::getline / std::istringstream loader, on a generated file. The number
+// of lines can be given as the first argument (default 4M).
+//
+//   g++ -std=c++17 -O2 bench/ParseBench.cpp -o parse_bench
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "../include/DictionaryParser.h"
+
+namespace
+{
+  double megabytesPerSecond(std::size_t bytes, std::chrono::steady_clock::time_point start)
+  {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+  }
+
+  std::size_t parseWithStreams(const std::string& path)
+  {
+    std::ifstream file(path);
+    std::size_t checksum = 0;
+    std::string line, englishWord, russianWord;
+    while (std::getline(file, line))
+    {
+      std::istringstream iss(line);
+      if (std::getline(iss, englishWord, '-') && std::getline(iss, russianWord))
+      {
+        englishWord.erase(englishWord.find_last_not_of(" ") + 1);
+        russianWord.erase(0, russianWord.find_first_not_of(" "));
+        checksum += englishWord.size() + russianWord.size();
+      }
+    }
+    return checksum;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t lines = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(1) << 22;
+  const std::string path = (std::filesystem::temp_directory_path() / "hashmap_parse_bench.txt").string();
+  {
+    std::ofstream file(path, std::ios::binary);
+    for (std::size_t i = 0; i < lines; i++)
+    {
+      file << "word" << i << " - translation" << i % 1000 << "\n";
+    }
+  }
+  std::size_t bytes = static_cast<std::size_t>(std::filesystem::file_size(path));
+
+  auto start = std::chrono::steady_clock::now();
+  std::size_t before = parseWithStreams(path);
+  double streams = megabytesPerSecond(bytes, start);
+
+  std::size_t after = 0;
+  ParseStats stats = parseDictionaryFile(path,
+    [&after](std::string_view word, std::string_view translation) { after += word.size() + translation.size(); },
+    [](std::string_view) {});
+
+  std::printf("%zu lines, %.1f MB\n", lines, static_cast<double>(bytes) / (1024.0 * 1024.0));
+  std::printf("getline/istringstream %10.1f MB/s\n", streams);
+  std::printf("parseDictionaryFile   %10.1f MB/s (%.2fx)\n", stats.megabytesPerSecond(), stats.megabytesPerSecond() / streams);
+  std::printf("(checksums %zu %zu)\n", before, after);
+  std::filesystem::remove(path);
+  return before == after ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Lookup cost of StaticDictionary against the hashed dictionaries, for words
+// that are present and words that are not, plus the time to find the perfect
+// hash. The tables are built at run time with StaticDictionaryBuilder, which
+// lays them out exactly as static_dictionary_gen does. The number of words can
+// be given as the first argument (default 1M).
+//
+//   cmake --build build --target static_bench && build/static_bench 1000000
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Dictionary.h"
+#include "../include/StaticDictionary.h"
+
+namespace
+{
+  const std::size_t LOOKUPS = 1 << 22;
+
+  template <class Dict>
+  void run(const char* name, Dict& dict, const std::vector<std::string>& hits, const std::vector<std::string>& misses)
+  {
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& key : hits)
+    {
+      sink += dict.find(key)->second.size();
+    }
+    double hitNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+      / static_cast<double>(hits.size());
+
+    start = std::chrono::steady_clock::now();
+    for (const std::string& key : misses)
+    {
+      sink += dict.find(key) == dict.end();
+    }
+    double missNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count()
+      / static_cast<double>(misses.size());
+
+    std::printf("%-18s %8.1f ns/hit %8.1f ns/miss (checksum %zu)\n", name, hitNs, missNs, sink);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  std::size_t words = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+  Dictionary dictionary;
+  FlatDictionary flat;
+  StaticDictionaryBuilder builder;
+  for (std::size_t i = 0; i < words; i++)
+  {
+    std::string word = "headword " + std::to_string(i);
+    std::string translation = "translation " + std::to_string(i % 1000);
+    dictionary.insert(word, translation);
+    flat.insert(word, translation);
+    builder.insert(word, translation);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  StaticDictionary table = builder.build();
+  double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  std::mt19937_64 rng(5);
+  std::uniform_int_distribution<std::size_t> pickWord(0, words - 1);
+  std::vector<std::string> hits(LOOKUPS);
+  std::vector<std::string> misses(LOOKUPS);
+  for (std::size_t i = 0; i < LOOKUPS; i++)
+  {
+    std::size_t word = pickWord(rng);
+    hits[i] = "headword " + std::to_string(word);
+    misses[i] = "headword " + std::to_string(word + words);
+  }
+
+  std::printf("%zu words, perfect hash found in %.2f s\n", words, buildSeconds);
+  run("Dictionary", dictionary, hits, misses);
+  run("FlatDictionary", flat, hits, misses);
+  run("StaticDictionary", table, hits, misses);
+  return 0;
+}
@@ -0,0 +1,44 @@
+#ifndef CHAIN_BUCKET_H
+#define CHAIN_BUCKET_H
+
+#include "LinkedListIterator.h"
+#include "ListNode.h"
+
+namespace detail
+{
+  // One bucket of a chained HashMap: just the head of its chain. The map
+  // creates and destroys the nodes with its own allocator, so a bucket needs
+  // neither an allocator nor a size and the bucket array is one pointer per
+  // bucket.
+  template <class T>
+  struct ChainBucket
+  {
+    using NodeType = ListNode<T>;
+    using iterator = ListIterator<T>;
+    using const_iterator = ConstListIterator<T>;
+
+    NodeType* head = nullptr;
+
+    bool empty() const { return head == nullptr; }
+    iterator begin() const { return iterator(head); }
+    iterator end() const { return iterator(); }
+    const_iterator cbegin() const { return const_iterator(head); }
+    const_iterator cend() const { return const_iterator(); }
+
+    NodeType* extractFront()
+    {
+      NodeType* node = head;
+      head = node->next;
+      node->next = nullptr;
+      return node;
+    }
+
+    void spliceFront(NodeType* node)
+    {
+      node->next = head;
+      head = node;
+    }
+  };
+}
+
+#endif
@@ -0,0 +1,274 @@
+#ifndef CONCURRENT_HASH_MAP_H
+#define CONCURRENT_HASH_MAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "ControlGroup.h"
+#include "FlatHashMap.h"
+#include "HashMap.h"
+
+namespace detail
+{
+  static const std::size_t DEFAULT_SHARD_COUNT = 16;
+  static const std::size_t CACHE_LINE_SIZE = 64;
+}
+
+// Thread-safe map made of independently locked HashMap shards. A key's shard
+// is picked from the bits of its mixed hash just below the top seven, which
+// a flat shard keeps as its control tag, while each shard indexes its
+// buckets with the low bits; the three choices use disjoint bits.
+// Readers of a shard share its lock and writers take it exclusively; a
+// resize of one shard therefore blocks only that part of the key space.
+//
+// Iterators cannot outlive a lock, so lookups copy the value out or run a
+// callback while the shard is locked. Every shard owns a default-constructed
+// allocator, which keeps single-threaded allocators such as PoolAllocator
+// private to one lock.
+template <class Key, class T, class Hash = std::hash<Key>, class Storage = detail::ChainedStorage,
+  class Allocator = std::allocator<detail::Pair<const Key, T>>>
+class ConcurrentHashMap
+{
+public:
+  using MapType = HashMap<Key, T, Hash, Storage, Allocator>;
+
+  explicit ConcurrentHashMap(std::size_t shardCount = detail::DEFAULT_SHARD_COUNT, std::size_t bucketCount = 8);
+  ConcurrentHashMap(const ConcurrentHashMap&) = delete;
+  ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete;
+
+  void insert(const Key& key, const T& value = T());
+  template <class... Args>
+  bool tryEmplace(const Key& key, Args&&... args);
+  template <class M>
+  bool insertOrAssign(const Key& key, M&& value);
+  bool find(const Key& key, T& value) const;
+  bool contains(const Key& key) const;
+  template <class F>
+  bool visit(const Key& key, F&& f) const;
+  template <class F>
+  bool update(const Key& key, F&& f);
+  template <class F, class... Args>
+  void updateOrEmplace(const Key& key, F&& f, Args&&... args);
+  bool remove(const Key& key);
+  template <class F>
+  void forEach(F&& f) const;
+  void clear();
+  void rehash(std::size_t count = 0);
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t shardCount() const;
+  void setMaxLoadFactor(float maxLoadFactor);
+
+private:
+  struct alignas(detail::CACHE_LINE_SIZE) Shard
+  {
+    mutable std::shared_mutex mutex;
+    MapType map;
+  };
+
+  std::size_t shardCount_;
+  std::size_t shardBits_;
+  std::unique_ptr<Shard[]> shards_;
+
+  Shard& shardFor(const Key& key) const;
+};
+
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::ConcurrentHashMap(std::size_t shardCount, std::size_t bucketCount)
+  : shardCount_(1), shardBits_(0)
+{
+  if (shardCount == 0)
+  {
+    throw std::invalid_argument("Shard count must be positive.");
+  }
+
+  while (shardCount_ < shardCount)
+  {
+    shardCount_ <<= 1;
+    ++shardBits_;
+  }
+  shards_.reset(new Shard[shardCount_]);
+
+  std::size_t shardBuckets = bucketCount / shardCount_;
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    shards_[i].map.rehash(shardBuckets);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::insert(const Key& key, const T& value)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  shard.map.insert(key, value);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class... Args>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::tryEmplace(const Key& key, Args&&... args)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.map.tryEmplace(key, std::forward<Args>(args)...).second;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class M>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::insertOrAssign(const Key& key, M&& value)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.map.insertOrAssign(key, std::forward<M>(value)).second;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::find(const Key& key, T& value) const
+{
+  return visit(key, [&value](const T& found) { value = found; });
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::contains(const Key& key) const
+{
+  return visit(key, [](const T&) {});
+}
+
+// Calls f(const T&) with the shard held in shared mode. The incremental
+// rehash mode is never enabled on shards, so find() leaves the shard
+// untouched and concurrent readers are safe.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class F>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::visit(const Key& key, F&& f) const
+{
+  Shard& shard = shardFor(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  auto pair_it = shard.map.find(key);
+  if (pair_it == shard.map.end())
+  {
+    return false;
+  }
+  f(static_cast<const T&>(pair_it->second));
+  return true;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class F>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::update(const Key& key, F&& f)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  auto pair_it = shard.map.find(key);
+  if (pair_it == shard.map.end())
+  {
+    return false;
+  }
+  f(pair_it->second);
+  return true;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class F, class... Args>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::updateOrEmplace(const Key& key, F&& f, Args&&... args)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  f(shard.map.tryEmplace(key, std::forward<Args>(args)...).first->second);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::remove(const Key& key)
+{
+  Shard& shard = shardFor(key);
+  std::unique_lock<std::shared_mutex> lock(shard.mutex);
+  return shard.map.remove(key);
+}
+
+// Visits every entry one shard at a time; entries of other shards may change
+// while a shard is being visited.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class F>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::forEach(F&& f) const
+{
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    for (auto it = shards_[i].map.cbegin(); it != shards_[i].map.cend(); ++it)
+    {
+      f(it->first, it->second);
+    }
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::clear()
+{
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].map.clear();
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::rehash(std::size_t count)
+{
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].map.rehash(count / shardCount_);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::size() const
+{
+  std::size_t total = 0;
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    std::shared_lock<std::shared_mutex> lock(shards_[i].mutex);
+    total += shards_[i].map.size();
+  }
+  return total;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::empty() const
+{
+  return size() == 0;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::shardCount() const
+{
+  return shardCount_;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::setMaxLoadFactor(float maxLoadFactor)
+{
+  for (std::size_t i = 0; i < shardCount_; i++)
+  {
+    std::unique_lock<std::shared_mutex> lock(shards_[i].mutex);
+    shards_[i].map.setMaxLoadFactor(maxLoadFactor);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::Shard& ConcurrentHashMap<Key, T, Hash, Storage, Allocator>::shardFor(const Key& key) const
+{
+  if (shardBits_ == 0)
+  {
+    return shards_[0];
+  }
+  std::uint64_t mixed = static_cast<std::uint64_t>(detail::mixHash(Hash{}(key)));
+  return shards_[static_cast<std::size_t>(mixed >> (detail::H2_SHIFT - shardBits_)) & (shardCount_ - 1)];
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef CONTROL_GROUP_H
+#define CONTROL_GROUP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HASH_MAP_USE_SSE2
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace detail
+{
+  // A control byte is either a special state (high bit set) or 7 bits of the
+  // hash of the key stored in a full slot.
+  using ControlByte = std::int8_t;
+
+  static constexpr ControlByte CTRL_EMPTY = -128;
+  static constexpr ControlByte CTRL_DELETED = -2;
+
+  inline bool isFull(ControlByte ctrl)
+  {
+    return ctrl >= 0;
+  }
+
+  inline std::size_t mixHash(std::size_t hash)
+  {
+    std::uint64_t mixed = static_cast<std::uint64_t>(hash) * 0x9E3779B97F4A7C15ull;
+    return static_cast<std::size_t>(mixed ^ (mixed >> 32));
+  }
+
+  // The top seven bits of a mixed hash are the control tag (H2).
+  static const unsigned H2_SHIFT = 57;
+
+  inline ControlByte hashH2(std::size_t mixed)
+  {
+    return static_cast<ControlByte>((static_cast<std::uint64_t>(mixed) >> H2_SHIFT) & 0x7F);
+  }
+
+  inline std::size_t countTrailingZeros(std::uint64_t value)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return index;
+#else
+    return static_cast<std::size_t>(__builtin_ctzll(value));
+#endif
+  }
+
+  inline std::size_t highestBitIndex(std::uint64_t value)
+  {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return index;
+#else
+    return 63 - static_cast<std::size_t>(__builtin_clzll(value));
+#endif
+  }
+
+  // Set of matching positions inside a group. Shift is log2 of the number of
+  // mask bits per control byte (0 for SIMD movemask, 3 for the portable path).
+  template <std::size_t Shift>
+  class BitMask
+  {
+  public:
+    explicit BitMask(std::uint64_t mask) : mask_(mask) {}
+
+    explicit operator bool() const { return mask_ != 0; }
+    std::size_t lowest() const { return countTrailingZeros(mask_) >> Shift; }
+    std::size_t highest() const { return highestBitIndex(mask_) >> Shift; }
+    void removeLowest() { mask_ &= mask_ - 1; }
+
+  private:
+    std::uint64_t mask_;
+  };
+
+#if defined(__AVX2__)
+  struct Group
+  {
+    static constexpr std::size_t WIDTH = 32;
+
+    explicit Group(const ControlByte* ctrl)
+      : ctrl_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ctrl))) {}
+
+    BitMask<0> match(ControlByte h2) const
+    {
+      return BitMask<0>(static_cast<std::uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl_))));
+    }
+
+    BitMask<0> matchEmpty() const
+    {
+      return match(CTRL_EMPTY);
+    }
+
+    BitMask<0> matchEmptyOrDeleted() const
+    {
+      return BitMask<0>(static_cast<std::uint32_t>(_mm256_movemask_epi8(ctrl_)));
+    }
+
+    __m256i ctrl_;
+  };
+#elif defined(HASH_MAP_USE_SSE2)
+  struct Group
+  {
+    static constexpr std::size_t WIDTH = 16;
+
+    explicit Group(const ControlByte* ctrl)
+      : ctrl_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    BitMask<0> match(ControlByte h2) const
+    {
+      return BitMask<0>(static_cast<std::uint32_t>(
+        _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl_))));
+    }
+
+    BitMask<0> matchEmpty() const
+    {
+      return match(CTRL_EMPTY);
+    }
+
+    BitMask<0> matchEmptyOrDeleted() const
+    {
+      return BitMask<0>(static_cast<std::uint32_t>(_mm_movemask_epi8(ctrl_)));
+    }
+
+    __m128i ctrl_;
+  };
+#else
+  struct Group
+  {
+    static constexpr std::size_t WIDTH = 8;
+    static constexpr std::uint64_t LSBS = 0x0101010101010101ull;
+    static constexpr std::uint64_t MSBS = 0x8080808080808080ull;
+
+    explicit Group(const ControlByte* ctrl)
+    {
+      std::memcpy(&ctrl_, ctrl, sizeof(ctrl_));
+    }
+
+    // May report false positives; callers always confirm with a key compare.
+    BitMask<3> match(ControlByte h2) const
+    {
+      std::uint64_t x = ctrl_ ^ (LSBS * static_cast<std::uint8_t>(h2));
+      return BitMask<3>((x - LSBS) & ~x & MSBS);
+    }
+
+    BitMask<3> matchEmpty() const
+    {
+      return BitMask<3>((ctrl_ & (~ctrl_ << 6)) & MSBS);
+    }
+
+    BitMask<3> matchEmptyOrDeleted() const
+    {
+      return BitMask<3>(ctrl_ & MSBS);
+    }
+
+    std::uint64_t ctrl_;
+  };
+#endif
+}
+
+#endif
@@ -0,0 +1,753 @@
+#ifndef DENSE_HASH_MAP_H
+#define DENSE_HASH_MAP_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ControlGroup.h"
+#include "HashMap.h"
+#include "ParallelFor.h"
+#include "Prefetch.h"
+
+namespace detail
+{
+  static const std::uint32_t DENSE_NO_ENTRY = UINT32_MAX;
+
+  // Index slot of a dense map: where the entry sits in the entry array and the
+  // low half of its hash. Home slots are taken from that half alone, so the
+  // index can be rebuilt without touching the entries.
+  struct DenseSlot
+  {
+    std::uint32_t position;
+    std::uint32_t hash;
+  };
+}
+
+
+// Entries are packed into one array in insertion order and the index, a
+// linearly probed array of DenseSlot, only stores their positions. Iteration
+// is a sweep over size() contiguous entries no matter how large the index
+// has grown. Removing moves the last entry into the gap, so it changes the
+// order and invalidates iterators to the last entry; inserting can
+// invalidate every iterator.
+template <class Key, class T, class Hash, class Allocator>
+class HashMap<Key, T, Hash, detail::DenseStorage, Allocator>
+{
+public:
+  using PairType = detail::Pair<const Key, T>;
+  using EntryAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<PairType>;
+
+  using iterator = PairType*;
+  using const_iterator = const PairType*;
+
+  HashMap(std::size_t bucketCount = 8, const Allocator& allocator = Allocator());
+  ~HashMap();
+  HashMap(const HashMap& table_) = delete;
+  HashMap(HashMap&& table_);
+  HashMap& operator=(const HashMap& src) = delete;
+  HashMap& operator=(HashMap&& src) noexcept;
+
+  void insert(const Key& key, const T& value = T());
+  void insert(Key&& key, T&& value);
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace(K&& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(const Key& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(Key&& key, Args&&... args);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(const Key& key, M&& value);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(Key&& key, M&& value);
+  template <class RandomIt>
+  void bulkLoad(RandomIt first, RandomIt last);
+  template <class RandomIt, class Make, class Merge>
+  void bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge);
+  iterator find(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  iterator find(const K& key);
+  template <class KeyIt, class OutputIt>
+  OutputIt findBatch(KeyIt first, KeyIt last, OutputIt out);
+  bool remove(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  bool remove(const K& key);
+  void clear();
+  void rehash(std::size_t count = 0);
+  void reserve(std::size_t count);
+  void shrinkToFit();
+  std::size_t size() const;
+  bool empty() const;
+  float loadFactor() const;
+  void setMaxLoadFactor(float maxLoadFactor);
+  void setMinLoadFactor(float minLoadFactor);
+  Allocator getAllocator() const;
+  void swap(HashMap& other) noexcept;
+#if defined(HASHMAP_ENABLE_STATS)
+  HashMapStats stats() const;
+#endif
+
+  iterator begin();
+  iterator end();
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+private:
+  std::size_t size_;
+  std::size_t capacity_;
+  PairType* entries_;
+  std::size_t bucketCount_;
+  std::vector<detail::DenseSlot> slots_;
+  float maxLoadFactor_;
+  float minLoadFactor_;
+  EntryAllocator allocator_;
+#if defined(HASHMAP_ENABLE_STATS)
+  detail::RehashCounters rehashCounters_;
+#endif
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> tryEmplaceImpl(K&& key, Args&&... args);
+  template <class K, class M>
+  std::pair<iterator, bool> insertOrAssignImpl(K&& key, M&& value);
+  template <class K, class... Args>
+  iterator insertNew(std::size_t index, std::size_t hash, K&& key, Args&&... args);
+
+  template <class K>
+  iterator findImpl(const K& key);
+  template <class K>
+  bool removeImpl(const K& key);
+
+  template <class K>
+  std::size_t computeHash(const K& key) const;
+  std::size_t growthLimit(std::size_t bucketCount) const;
+  std::size_t bucketCountFor(std::size_t count) const;
+  void resize(std::size_t bucketCount);
+  void shrinkIfSparse();
+  template <class K>
+  std::size_t findSlot(const K& key, std::size_t hash) const;
+  std::size_t findFreeSlot(std::size_t hash) const;
+  std::size_t findPosition(std::size_t position) const;
+  void eraseSlot(std::size_t index);
+  void destroyEntries();
+};
+
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::HashMap(std::size_t initialBucketCount, const Allocator& allocator)
+  : size_(0), capacity_(0), entries_(nullptr), bucketCount_(detail::MIN_BUCKET_COUNT),
+    maxLoadFactor_(detail::DEFAULT_MAX_LOAD_FACTOR), minLoadFactor_(detail::DEFAULT_MIN_LOAD_FACTOR),
+    allocator_(allocator)
+{
+  while (bucketCount_ < initialBucketCount)
+  {
+    bucketCount_ <<= 1;
+  }
+  slots_.assign(bucketCount_, detail::DenseSlot{ detail::DENSE_NO_ENTRY, 0 });
+  capacity_ = growthLimit(bucketCount_);
+  entries_ = std::allocator_traits<EntryAllocator>::allocate(allocator_, capacity_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::~HashMap()
+{
+  destroyEntries();
+  std::allocator_traits<EntryAllocator>::deallocate(allocator_, entries_, capacity_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::HashMap(HashMap&& other) : HashMap(detail::MIN_BUCKET_COUNT, other.allocator_)
+{
+  swap(other);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::DenseStorage, Allocator>& HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::operator=(HashMap&& other) noexcept
+{
+  if (this != &other)
+  {
+    swap(other);
+  }
+  return *this;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insert(const Key& key, const T& value)
+{
+  insertOrAssignImpl(key, value);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insert(Key&& key, T&& value)
+{
+  insertOrAssignImpl(std::move(key), std::move(value));
+}
+
+// With a transparent hash, a key of another type is looked up as it is and
+// only converted to Key if it has to be inserted.
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::emplace(K&& key, Args&&... args)
+{
+  if constexpr (std::is_same_v<std::decay_t<K>, Key> || detail::IsTransparent<Hash>::value)
+  {
+    return tryEmplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+  else
+  {
+    return tryEmplaceImpl(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::tryEmplace(const Key& key, Args&&... args)
+{
+  return tryEmplaceImpl(key, std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::tryEmplace(Key&& key, Args&&... args)
+{
+  return tryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insertOrAssign(const Key& key, M&& value)
+{
+  return insertOrAssignImpl(key, std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insertOrAssign(Key&& key, M&& value)
+{
+  return insertOrAssignImpl(std::move(key), std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::tryEmplaceImpl(K&& key, Args&&... args)
+{
+  std::size_t hash = computeHash(key);
+  std::size_t index = findSlot(key, hash);
+  std::size_t position = slots_[index].position;
+  if (position != detail::DENSE_NO_ENTRY)
+  {
+    return { entries_ + position, false };
+  }
+  return { insertNew(index, hash, std::forward<K>(key), std::forward<Args>(args)...), true };
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class M>
+std::pair<typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insertOrAssignImpl(K&& key, M&& value)
+{
+  std::size_t hash = computeHash(key);
+  std::size_t index = findSlot(key, hash);
+  std::size_t position = slots_[index].position;
+  if (position != detail::DENSE_NO_ENTRY)
+  {
+    entries_[position].second = std::forward<M>(value);
+    return { entries_ + position, false };
+  }
+  return { insertNew(index, hash, std::forward<K>(key), std::forward<M>(value)), true };
+}
+
+// index is the empty slot the caller's lookup stopped at. Only a rehash
+// moves it, and then the key is known to be missing, so the new slot is
+// found without comparing keys.
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::insertNew(std::size_t index, std::size_t hash, K&& key, Args&&... args)
+{
+  if (size_ == detail::DENSE_NO_ENTRY)
+  {
+    throw std::length_error("Dense hash map is out of positions.");
+  }
+  if (size_ >= growthLimit(bucketCount_) || size_ == capacity_)
+  {
+    rehash();
+    index = findFreeSlot(hash);
+  }
+
+  new (entries_ + size_) PairType(std::in_place, std::forward<K>(key), std::forward<Args>(args)...);
+  slots_[index] = detail::DenseSlot{ static_cast<std::uint32_t>(size_), static_cast<std::uint32_t>(hash) };
+  return entries_ + size_++;
+}
+
+// Same contract as the chained bulkLoad. Only sizing and hashing happen in
+// parallel; entries are appended in input order.
+template <class Key, class T, class Hash, class Allocator>
+template <class RandomIt, class Make, class Merge>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge)
+{
+  std::size_t count = static_cast<std::size_t>(last - first);
+  if (count == 0)
+  {
+    return;
+  }
+
+  if (size_ + count > growthLimit(bucketCount_) || size_ + count > capacity_)
+  {
+    std::size_t bucketCount = bucketCount_;
+    while (growthLimit(bucketCount) <= size_ + count)
+    {
+      bucketCount <<= 1;
+    }
+    rehash(bucketCount);
+  }
+
+  std::size_t threadCount = detail::bulkLoadThreads<Allocator>(count);
+  std::vector<std::size_t> hashes(count);
+  detail::parallelFor(threadCount, [&](std::size_t chunk)
+  {
+    for (std::size_t i = count * chunk / threadCount; i < count * (chunk + 1) / threadCount; i++)
+    {
+      hashes[i] = computeHash(first[i].first);
+    }
+  });
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    auto&& element = first[i];
+    std::size_t index = findSlot(element.first, hashes[i]);
+    std::size_t position = slots_[index].position;
+    if (position != detail::DENSE_NO_ENTRY)
+    {
+      merge(entries_[position].second, element);
+    }
+    else
+    {
+      insertNew(index, hashes[i], element.first, make(element));
+    }
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class RandomIt>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::bulkLoad(RandomIt first, RandomIt last)
+{
+  bulkLoad(first, last,
+    [](const auto& element) { return T(element.second); },
+    [](T& value, const auto& element) { value = element.second; });
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::find(const Key& key)
+{
+  return findImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::find(const K& key)
+{
+  return findImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::findImpl(const K& key)
+{
+  std::size_t position = slots_[findSlot(key, computeHash(key))].position;
+  return position == detail::DENSE_NO_ENTRY ? end() : entries_ + position;
+}
+
+// Same contract as the chained findBatch: a block of keys is hashed and the
+// home slot of every probe is prefetched before any of them is resolved.
+template <class Key, class T, class Hash, class Allocator>
+template <class KeyIt, class OutputIt>
+OutputIt HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::findBatch(KeyIt first, KeyIt last, OutputIt out)
+{
+  std::size_t hashes[detail::FIND_BATCH_BLOCK];
+  while (first != last)
+  {
+    KeyIt blockFirst = first;
+    std::size_t count = 0;
+    for (; first != last && count < detail::FIND_BATCH_BLOCK; ++first, ++count)
+    {
+      hashes[count] = computeHash(*first);
+      detail::prefetch(slots_.data() + (static_cast<std::uint32_t>(hashes[count]) & (bucketCount_ - 1)));
+    }
+
+    for (std::size_t i = 0; i < count; i++, ++blockFirst)
+    {
+      std::size_t position = slots_[findSlot(*blockFirst, hashes[i])].position;
+      *out++ = position == detail::DENSE_NO_ENTRY ? end() : entries_ + position;
+    }
+  }
+  return out;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+bool HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::remove(const Key& key)
+{
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class>
+bool HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::remove(const K& key)
+{
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+bool HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::removeImpl(const K& key)
+{
+  std::size_t index = findSlot(key, computeHash(key));
+  std::size_t position = slots_[index].position;
+  if (position == detail::DENSE_NO_ENTRY)
+  {
+    return false;
+  }
+  eraseSlot(index);
+  entries_[position].~PairType();
+
+  // Fill the gap with the last entry so the array stays packed.
+  std::size_t lastPosition = size_ - 1;
+  if (position != lastPosition)
+  {
+    PairType& moved = entries_[lastPosition];
+    slots_[findPosition(lastPosition)].position = static_cast<std::uint32_t>(position);
+    detail::relocatePair(entries_ + position, moved);
+  }
+  --size_;
+  shrinkIfSparse();
+  return true;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::clear()
+{
+  destroyEntries();
+  std::fill(slots_.begin(), slots_.end(), detail::DenseSlot{ detail::DENSE_NO_ENTRY, 0 });
+  size_ = 0;
+  shrinkIfSparse();
+}
+
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::size() const
+{
+  return size_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+bool HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::empty() const
+{
+  return size_ == 0;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+float HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::loadFactor() const
+{
+  return static_cast<float>(size_) / static_cast<float>(bucketCount_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::setMaxLoadFactor(float maxLoadFactor)
+{
+  if (maxLoadFactor < 0.05f || maxLoadFactor > 1.0f)
+  {
+    throw std::invalid_argument("Load factor must be greater than 0.05 and less than 1.");
+  }
+  if (maxLoadFactor < 2 * minLoadFactor_)
+  {
+    throw std::invalid_argument("Maximum load factor must be at least twice the minimum load factor.");
+  }
+  maxLoadFactor_ = maxLoadFactor;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::setMinLoadFactor(float minLoadFactor)
+{
+  if (minLoadFactor < 0.0f || 2 * minLoadFactor > maxLoadFactor_)
+  {
+    throw std::invalid_argument("Minimum load factor must be non-negative and at most half the maximum load factor.");
+  }
+  minLoadFactor_ = minLoadFactor;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+Allocator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::getAllocator() const
+{
+  return Allocator(allocator_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::swap(HashMap& other) noexcept
+{
+  std::swap(size_, other.size_);
+  std::swap(capacity_, other.capacity_);
+  std::swap(entries_, other.entries_);
+  std::swap(bucketCount_, other.bucketCount_);
+  slots_.swap(other.slots_);
+  std::swap(maxLoadFactor_, other.maxLoadFactor_);
+  std::swap(minLoadFactor_, other.minLoadFactor_);
+  std::swap(allocator_, other.allocator_);
+#if defined(HASHMAP_ENABLE_STATS)
+  std::swap(rehashCounters_, other.rehashCounters_);
+#endif
+}
+
+#if defined(HASHMAP_ENABLE_STATS)
+// Lengths are probe distances from the home slot; the entry array counts as
+// node memory.
+template <class Key, class T, class Hash, class Allocator>
+HashMapStats HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::stats() const
+{
+  HashMapStats stats;
+  stats.size = size_;
+  stats.bucketCount = bucketCount_;
+  stats.emptyBuckets = bucketCount_ - size_;
+  stats.rehashCount = rehashCounters_.count;
+  stats.rehashSeconds = std::chrono::duration<double>(rehashCounters_.time).count();
+  stats.bucketBytes = bucketCount_ * sizeof(detail::DenseSlot);
+  stats.nodeBytes = capacity_ * sizeof(PairType);
+
+  std::size_t mask = bucketCount_ - 1;
+  for (std::size_t i = 0; i < bucketCount_; i++)
+  {
+    if (slots_[i].position != detail::DENSE_NO_ENTRY)
+    {
+      stats.addLength((i - slots_[i].hash) & mask);
+    }
+  }
+  for (std::size_t i = 0; i < size_; i++)
+  {
+    stats.elementBytes += detail::heapBytes(entries_[i].first) + detail::heapBytes(entries_[i].second);
+  }
+  return stats;
+}
+#endif
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::begin()
+{
+  return entries_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::end()
+{
+  return entries_ + size_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::const_iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::cbegin() const
+{
+  return entries_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::const_iterator HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::cend() const
+{
+  return entries_ + size_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::computeHash(const K& key) const
+{
+  return detail::mixHash(Hash{}(key));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::growthLimit(std::size_t bucketCount) const
+{
+  // At least one slot always stays empty so that unsuccessful probes terminate.
+  std::size_t limit = static_cast<std::size_t>(bucketCount * maxLoadFactor_);
+  return limit < bucketCount ? limit : bucketCount - 1;
+}
+
+// Index of the slot holding key, or of the empty slot where it belongs.
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::findSlot(const K& key, std::size_t hash) const
+{
+  std::size_t mask = bucketCount_ - 1;
+  std::uint32_t tag = static_cast<std::uint32_t>(hash);
+  for (std::size_t index = tag & mask;; index = (index + 1) & mask)
+  {
+    const detail::DenseSlot& slot = slots_[index];
+    if (slot.position == detail::DENSE_NO_ENTRY || (slot.hash == tag && entries_[slot.position].first == key))
+    {
+      return index;
+    }
+  }
+}
+
+// Index of the first empty slot in hash's probe run.
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::findFreeSlot(std::size_t hash) const
+{
+  std::size_t mask = bucketCount_ - 1;
+  std::size_t index = static_cast<std::uint32_t>(hash) & mask;
+  while (slots_[index].position != detail::DENSE_NO_ENTRY)
+  {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+// Index of the slot pointing at the entry in the given position.
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::findPosition(std::size_t position) const
+{
+  std::size_t mask = bucketCount_ - 1;
+  std::size_t index = static_cast<std::uint32_t>(computeHash(entries_[position].first)) & mask;
+  while (slots_[index].position != position)
+  {
+    index = (index + 1) & mask;
+  }
+  return index;
+}
+
+// Empties a slot and shifts back later members of its probe run, so lookups
+// never need tombstones.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::eraseSlot(std::size_t index)
+{
+  std::size_t mask = bucketCount_ - 1;
+  std::size_t hole = index;
+  for (std::size_t next = (hole + 1) & mask; slots_[next].position != detail::DENSE_NO_ENTRY; next = (next + 1) & mask)
+  {
+    // An entry can fill the hole only if the hole is not before its home slot.
+    std::size_t home = slots_[next].hash & mask;
+    if (((next - home) & mask) >= ((next - hole) & mask))
+    {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+  }
+  slots_[hole].position = detail::DENSE_NO_ENTRY;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::destroyEntries()
+{
+  for (std::size_t i = 0; i < size_; i++)
+  {
+    entries_[i].~PairType();
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::rehash(std::size_t minSize)
+{
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount < minSize || growthLimit(bucketCount) <= size_)
+  {
+    bucketCount <<= 1;
+  }
+  resize(bucketCount);
+}
+
+// Sizes the table for count elements, or for size() if that is larger, in
+// either direction.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::reserve(std::size_t count)
+{
+  std::size_t bucketCount = bucketCountFor(count > size_ ? count : size_);
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::shrinkToFit()
+{
+  std::size_t bucketCount = bucketCountFor(size_);
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+// Smallest index size that takes count elements without growing.
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::bucketCountFor(std::size_t count) const
+{
+  std::size_t bucketCount = detail::MIN_BUCKET_COUNT;
+  while (growthLimit(bucketCount) < count)
+  {
+    bucketCount <<= 1;
+  }
+  return bucketCount;
+}
+
+// Halves the index until the load factor reaches the minimum.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::shrinkIfSparse()
+{
+  if (minLoadFactor_ == 0.0f)
+  {
+    return;
+  }
+
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount > detail::MIN_BUCKET_COUNT && size_ < bucketCount * minLoadFactor_)
+  {
+    bucketCount >>= 1;
+  }
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+// Gives the index bucketCount slots and sizes the entry array to what that
+// index allows. Slots keep their hashes, so no key is hashed again.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::DenseStorage, Allocator>::resize(std::size_t bucketCount)
+{
+#if defined(HASHMAP_ENABLE_STATS)
+  rehashCounters_.count++;
+  detail::RehashTimer timer(rehashCounters_);
+#endif
+  bucketCount_ = bucketCount;
+
+  std::size_t capacity = growthLimit(bucketCount_);
+  if (capacity != capacity_)
+  {
+    PairType* entries = std::allocator_traits<EntryAllocator>::allocate(allocator_, capacity);
+    for (std::size_t i = 0; i < size_; i++)
+    {
+      detail::relocatePair(entries + i, entries_[i]);
+    }
+    std::allocator_traits<EntryAllocator>::deallocate(allocator_, entries_, capacity_);
+    entries_ = entries;
+    capacity_ = capacity;
+  }
+
+  if (slots_.size() != bucketCount_)
+  {
+    std::vector<detail::DenseSlot> slots(bucketCount_, detail::DenseSlot{ detail::DENSE_NO_ENTRY, 0 });
+    std::size_t mask = bucketCount_ - 1;
+    for (const detail::DenseSlot& slot : slots_)
+    {
+      if (slot.position == detail::DENSE_NO_ENTRY)
+      {
+        continue;
+      }
+      std::size_t index = slot.hash & mask;
+      while (slots[index].position != detail::DENSE_NO_ENTRY)
+      {
+        index = (index + 1) & mask;
+      }
+      slots[index] = slot;
+    }
+    slots_.swap(slots);
+  }
+}
+
+#endif
@@ -2,19 +2,84 @@
 #define DICTIONARY_H
 
 #include <iostream>
+#include <string>
+#include <string_view>
 
+#include "DenseHashMap.h"
+#include "FlatHashMap.h"
 #include "Hash.h"
 #include "HashMap.h"
 #include "LinkedList.h"
+#include "PoolAllocator.h"
+#include "SmallSortedSet.h"
+
+namespace detail
+{
+  // Translations kept inside each entry before the list spills to the heap.
+  // Each one is a whole std::string inside every node or slot, empty flat
+  // slots included, so only the common single-translation word stays inline.
+  static const std::size_t INLINE_TRANSLATIONS = 1;
+
+  template <template <class> class Allocator>
+  using TranslationList = SmallSortedSet<std::string, INLINE_TRANSLATIONS, Allocator<std::string>>;
+}
 
 
-class Dictionary : public HashMap<std::string, SortedUniqueList<std::string>, detail::StringHash>
+template <class Storage = detail::ChainedStorage, template <class> class Allocator = std::allocator>
+class BasicDictionary : public HashMap<std::string, detail::TranslationList<Allocator>,
+  detail::StringHash, Storage, Allocator<detail::Pair<const std::string, detail::TranslationList<Allocator>>>>
 {
 public:
-  Dictionary(size_t capacity = 8);
+  using TranslationList = detail::TranslationList<Allocator>;
+  using BaseType = HashMap<std::string, TranslationList, detail::StringHash, Storage,
+    Allocator<detail::Pair<const std::string, TranslationList>>>;
+  using StorageType = Storage;
+  using iterator = typename BaseType::iterator;
+  using const_iterator = typename BaseType::const_iterator;
 
-  void insert(const std::string& key, const std::string& value);
-  void remove(const std::string& key, const std::string& value);
+  BasicDictionary(size_t capacity = 8);
+
+  void insert(std::string_view key, std::string_view value);
+  void remove(std::string_view key, std::string_view value);
+  template <class RandomIt>
+  void bulkLoad(RandomIt first, RandomIt last);
+  void saveSnapshot(const std::string& path) const;
 };
 
+
+// Adds every (word, translation) pair of [first, last). Translations of a
+// repeated word are merged into its sorted list, so the result does not
+// depend on how the load is split across threads. Elements may hold
+// string_views; a string is built only for a word or translation that is new.
+template <class Storage, template <class> class Allocator>
+template <class RandomIt>
+void BasicDictionary<Storage, Allocator>::bulkLoad(RandomIt first, RandomIt last)
+{
+  auto allocator = this->getAllocator();
+  BaseType::bulkLoad(first, last,
+    [&allocator](const auto& element)
+    {
+      TranslationList lst(allocator);
+      lst.emplace(element.second);
+      return lst;
+    },
+    [](TranslationList& lst, const auto& element)
+    {
+      if (!lst.contains(element.second))
+      {
+        lst.emplace(element.second);
+      }
+    });
+}
+
+using Dictionary = BasicDictionary<detail::ChainedStorage>;
+using FlatDictionary = BasicDictionary<detail::FlatStorage>;
+using DenseDictionary = BasicDictionary<detail::DenseStorage>;
+using PooledDictionary = BasicDictionary<detail::ChainedStorage, PoolAllocator>;
+
+extern template class BasicDictionary<detail::ChainedStorage>;
+extern template class BasicDictionary<detail::FlatStorage>;
+extern template class BasicDictionary<detail::DenseStorage>;
+extern template class BasicDictionary<detail::ChainedStorage, PoolAllocator>;
+
 #endif
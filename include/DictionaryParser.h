@@ -0,0 +1,155 @@
+#ifndef DICTIONARY_PARSER_H
+#define DICTIONARY_PARSER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace detail
+{
+  static const std::size_t PARSE_BLOCK_SIZE = 1 << 20;
+
+  // Splits one "word - translation" line: the word runs up to the first '-'
+  // and loses its trailing spaces, the translation is the rest of the line
+  // without its leading spaces. A line without '-' or with nothing after it
+  // is malformed.
+  template <class OnEntry, class OnError>
+  bool parseLine(std::string_view line, OnEntry& onEntry, OnError& onError)
+  {
+    const char* dash = static_cast<const char*>(std::memchr(line.data(), '-', line.size()));
+    if (dash == nullptr || dash + 1 == line.data() + line.size())
+    {
+      onError(line);
+      return false;
+    }
+
+    std::string_view word(line.data(), static_cast<std::size_t>(dash - line.data()));
+    std::string_view translation(dash + 1, line.size() - word.size() - 1);
+    while (!word.empty() && word.back() == ' ')
+    {
+      word.remove_suffix(1);
+    }
+    while (!translation.empty() && translation.front() == ' ')
+    {
+      translation.remove_prefix(1);
+    }
+    onEntry(word, translation);
+    return true;
+  }
+}
+
+struct ParseStats
+{
+  std::size_t bytes = 0;
+  std::size_t lines = 0;
+  std::size_t entries = 0;
+  std::size_t malformed = 0;
+  double seconds = 0;
+
+  double megabytesPerSecond() const
+  {
+    return seconds > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0;
+  }
+};
+
+// Parses "word - translation" text, one entry per line. A final line break
+// does not start another line, matching std::getline. Lines are located
+// with memchr, which the C library vectorizes, and handed to
+// onEntry(word, translation) / onError(line) as string_views into the text,
+// valid only for the duration of the call.
+template <class OnEntry, class OnError>
+ParseStats parseDictionaryText(std::string_view text, OnEntry&& onEntry, OnError&& onError)
+{
+  auto start = std::chrono::steady_clock::now();
+  ParseStats stats;
+  stats.bytes = text.size();
+
+  const char* cursor = text.data();
+  const char* end = text.data() + text.size();
+  while (cursor != end)
+  {
+    const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<std::size_t>(end - cursor)));
+    const char* lineEnd = newline != nullptr ? newline : end;
+    ++stats.lines;
+    if (detail::parseLine(std::string_view(cursor, static_cast<std::size_t>(lineEnd - cursor)), onEntry, onError))
+    {
+      ++stats.entries;
+    }
+    else
+    {
+      ++stats.malformed;
+    }
+    cursor = newline != nullptr ? newline + 1 : end;
+  }
+
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+// Streams a file through parseDictionaryText() in blocks of blockSize bytes.
+template <class OnEntry, class OnError>
+ParseStats parseDictionaryFile(const std::string& path, OnEntry&& onEntry, OnError&& onError,
+  std::size_t blockSize = detail::PARSE_BLOCK_SIZE)
+{
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<std::FILE, int (*)(std::FILE*)> file(std::fopen(path.c_str(), "rb"), &std::fclose);
+  if (!file)
+  {
+    throw std::runtime_error("Could not open file '" + path + "'.");
+  }
+
+  ParseStats stats;
+  std::vector<char> buffer(blockSize);
+  std::size_t carried = 0;
+  while (true)
+  {
+    // A line longer than the block grows the buffer instead of being split.
+    if (carried == buffer.size())
+    {
+      buffer.resize(buffer.size() * 2);
+    }
+
+    std::size_t read = std::fread(buffer.data() + carried, 1, buffer.size() - carried, file.get());
+    std::size_t filled = carried + read;
+    if (read == 0)
+    {
+      if (std::ferror(file.get()))
+      {
+        throw std::runtime_error("Could not read file '" + path + "'.");
+      }
+      ParseStats tail = parseDictionaryText(std::string_view(buffer.data(), filled), onEntry, onError);
+      stats.lines += tail.lines;
+      stats.entries += tail.entries;
+      stats.malformed += tail.malformed;
+      break;
+    }
+
+    // Parse every complete line and carry the partial last one over.
+    std::size_t complete = filled;
+    while (complete > 0 && buffer[complete - 1] != '\n')
+    {
+      --complete;
+    }
+    if (complete > 0)
+    {
+      ParseStats block = parseDictionaryText(std::string_view(buffer.data(), complete), onEntry, onError);
+      stats.lines += block.lines;
+      stats.entries += block.entries;
+      stats.malformed += block.malformed;
+    }
+    carried = filled - complete;
+    std::memmove(buffer.data(), buffer.data() + complete, carried);
+    stats.bytes += read;
+  }
+
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return stats;
+}
+
+#endif
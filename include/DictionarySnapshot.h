@@ -0,0 +1,149 @@
+#ifndef DICTIONARY_SNAPSHOT_H
+#define DICTIONARY_SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace detail
+{
+  // Snapshot file layout, all sections 8-byte aligned and in native byte
+  // order:
+  //   SnapshotHeader
+  //   SnapshotSlot[slotCount]      open-addressed index, linear probing
+  //   SnapshotString[stringCount]  translation references, grouped per word
+  //   char[arenaSize]              words and translations, not terminated
+  static constexpr char SNAPSHOT_MAGIC[8] = { 'H', 'M', 'D', 'S', 'N', 'A', 'P', '\0' };
+  static const std::uint32_t SNAPSHOT_VERSION = 1;
+  static const std::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+  static const std::uint32_t SNAPSHOT_EMPTY_SLOT = UINT32_MAX;
+
+  struct SnapshotHeader
+  {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t entryCount;
+    std::uint64_t slotCount;
+    std::uint64_t slotsOffset;
+    std::uint64_t stringCount;
+    std::uint64_t stringsOffset;
+    std::uint64_t arenaSize;
+    std::uint64_t arenaOffset;
+  };
+
+  struct SnapshotSlot
+  {
+    std::uint64_t hash;
+    std::uint64_t keyOffset;
+    std::uint64_t translationsBegin;
+    std::uint32_t keyLength;
+    std::uint32_t translationCount;
+  };
+
+  struct SnapshotString
+  {
+    std::uint64_t offset;
+    std::uint64_t length;
+  };
+
+  // Collects words in iteration order; every addTranslation() belongs to the
+  // most recent addWord().
+  class SnapshotWriter
+  {
+  public:
+    explicit SnapshotWriter(std::size_t wordCount = 0);
+
+    void addWord(std::string_view word);
+    void addTranslation(std::string_view translation);
+    void save(const std::string& path) const;
+
+  private:
+    std::vector<SnapshotSlot> entries_;
+    std::vector<SnapshotString> strings_;
+    std::string arena_;
+
+    std::uint64_t appendString(std::string_view value);
+  };
+}
+
+
+// Translations of one word, viewed in place inside a mapped snapshot.
+class SnapshotTranslations
+{
+public:
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::string_view;
+    using reference = std::string_view;
+    using pointer = void;
+
+    const_iterator(const detail::SnapshotString* string, const char* arena) : string_(string), arena_(arena) {}
+
+    std::string_view operator*() const { return std::string_view(arena_ + string_->offset, string_->length); }
+    const_iterator& operator++() { ++string_; return *this; }
+    const_iterator operator++(int) { const_iterator temp = *this; ++string_; return temp; }
+    bool operator==(const const_iterator& other) const { return string_ == other.string_; }
+    bool operator!=(const const_iterator& other) const { return string_ != other.string_; }
+
+  private:
+    const detail::SnapshotString* string_;
+    const char* arena_;
+  };
+
+  SnapshotTranslations() : strings_(nullptr), count_(0), arena_(nullptr) {}
+  SnapshotTranslations(const detail::SnapshotString* strings, std::size_t count, const char* arena)
+    : strings_(strings), count_(count), arena_(arena) {}
+
+  bool empty() const { return count_ == 0; }
+  std::size_t size() const { return count_; }
+  std::string_view operator[](std::size_t index) const { return *const_iterator(strings_ + index, arena_); }
+  const_iterator begin() const { return const_iterator(strings_, arena_); }
+  const_iterator end() const { return const_iterator(strings_ + count_, arena_); }
+
+private:
+  const detail::SnapshotString* strings_;
+  std::size_t count_;
+  const char* arena_;
+};
+
+
+// Read-only dictionary served straight from a memory-mapped snapshot written
+// by BasicDictionary::saveSnapshot(). Opening validates only the header and
+// section bounds, so it costs no parsing or allocation, and every process
+// mapping the same file shares one copy in the page cache. find() checks the
+// word and translations it returns against the arena.
+class DictionarySnapshot
+{
+public:
+  explicit DictionarySnapshot(const std::string& path);
+  ~DictionarySnapshot();
+  DictionarySnapshot(const DictionarySnapshot&) = delete;
+  DictionarySnapshot& operator=(const DictionarySnapshot&) = delete;
+  DictionarySnapshot(DictionarySnapshot&& other) noexcept;
+  DictionarySnapshot& operator=(DictionarySnapshot&& other) noexcept;
+
+  SnapshotTranslations find(std::string_view word) const;
+  bool contains(std::string_view word) const;
+  std::size_t size() const;
+  bool empty() const;
+
+private:
+  const char* data_;
+  std::size_t fileSize_;
+  const detail::SnapshotHeader* header_;
+  const detail::SnapshotSlot* slots_;
+  const detail::SnapshotString* strings_;
+  const char* arena_;
+
+  void validate(const std::string& path);
+  void unmap();
+};
+
+#endif
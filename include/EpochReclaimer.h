@@ -0,0 +1,248 @@
+#ifndef EPOCH_RECLAIMER_H
+#define EPOCH_RECLAIMER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace detail
+{
+  static constexpr std::uint64_t EPOCH_QUIESCENT = UINT64_MAX;
+  static const std::size_t EPOCH_RETIRE_BATCH = 64;
+
+  // Epoch-based reclamation. A reader pins the current global epoch while it
+  // dereferences shared pointers; a writer unlinks an object and retires it
+  // with the epoch of the moment. The global epoch only advances once every
+  // pinned thread has observed it, so an object retired in epoch e is
+  // unreachable for all readers once the epoch reaches e + 2.
+  class EpochDomain
+  {
+  public:
+    struct Record
+    {
+      std::atomic<std::uint64_t> epoch{ EPOCH_QUIESCENT };
+      std::atomic<bool> inUse{ true };
+      std::size_t nesting = 0;
+      Record* next = nullptr;
+    };
+
+    static EpochDomain& instance();
+
+    ~EpochDomain();
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator=(const EpochDomain&) = delete;
+
+    void pin();
+    void unpin();
+    void retire(void* object, void (*deleter)(void*));
+    void collect();
+
+  private:
+    struct Retired
+    {
+      void* object;
+      void (*deleter)(void*);
+      std::uint64_t epoch;
+    };
+
+    // Gives the calling thread's record back to the domain when it exits.
+    struct LocalRecord
+    {
+      Record* record;
+
+      explicit LocalRecord(EpochDomain& domain) : record(domain.acquireRecord()) {}
+      ~LocalRecord() { record->inUse.store(false, std::memory_order_release); }
+    };
+
+    std::atomic<std::uint64_t> globalEpoch_;
+    std::atomic<Record*> records_;
+    std::mutex retiredMutex_;
+    std::vector<Retired> retired_;
+
+    EpochDomain();
+    Record* localRecord();
+    Record* acquireRecord();
+    bool tryAdvance();
+    void freeRetired();
+  };
+
+  // Keeps the calling thread pinned for its lifetime. Guards nest, and copies
+  // pin again, so they can be stored inside iterators.
+  class EpochGuard
+  {
+  public:
+    explicit EpochGuard(bool pinned = true);
+    EpochGuard(const EpochGuard& other);
+    EpochGuard& operator=(const EpochGuard& other);
+    ~EpochGuard();
+
+  private:
+    bool pinned_;
+  };
+
+
+  inline EpochDomain::EpochDomain() : globalEpoch_(0), records_(nullptr) {}
+
+  inline EpochDomain::~EpochDomain()
+  {
+    for (const Retired& retired : retired_)
+    {
+      retired.deleter(retired.object);
+    }
+
+    Record* record = records_.load();
+    while (record != nullptr)
+    {
+      Record* next = record->next;
+      delete record;
+      record = next;
+    }
+  }
+
+  inline EpochDomain& EpochDomain::instance()
+  {
+    static EpochDomain domain;
+    return domain;
+  }
+
+  inline EpochDomain::Record* EpochDomain::localRecord()
+  {
+    thread_local LocalRecord local(*this);
+    return local.record;
+  }
+
+  inline EpochDomain::Record* EpochDomain::acquireRecord()
+  {
+    for (Record* record = records_.load(); record != nullptr; record = record->next)
+    {
+      bool expected = false;
+      if (record->inUse.compare_exchange_strong(expected, true))
+      {
+        return record;
+      }
+    }
+
+    Record* record = new Record;
+    record->next = records_.load();
+    while (!records_.compare_exchange_weak(record->next, record))
+    {
+    }
+    return record;
+  }
+
+  inline void EpochDomain::pin()
+  {
+    Record* record = localRecord();
+    if (record->nesting++ == 0)
+    {
+      record->epoch.store(globalEpoch_.load());
+      // The announcement must be visible before any shared pointer is read.
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  inline void EpochDomain::unpin()
+  {
+    Record* record = localRecord();
+    if (--record->nesting == 0)
+    {
+      record->epoch.store(EPOCH_QUIESCENT, std::memory_order_release);
+    }
+  }
+
+  inline void EpochDomain::retire(void* object, void (*deleter)(void*))
+  {
+    // Pairs with the fence in pin(): a reader that can still reach the
+    // unlinked object has announced an epoch this scan will see.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::lock_guard<std::mutex> lock(retiredMutex_);
+    retired_.push_back({ object, deleter, globalEpoch_.load() });
+    if (retired_.size() % EPOCH_RETIRE_BATCH == 0)
+    {
+      tryAdvance();
+      freeRetired();
+    }
+  }
+
+  // Advances the epoch as far as the pinned threads allow and frees whatever
+  // became unreachable.
+  inline void EpochDomain::collect()
+  {
+    std::lock_guard<std::mutex> lock(retiredMutex_);
+    if (tryAdvance())
+    {
+      tryAdvance();
+    }
+    freeRetired();
+  }
+
+  inline bool EpochDomain::tryAdvance()
+  {
+    std::uint64_t epoch = globalEpoch_.load();
+    for (Record* record = records_.load(); record != nullptr; record = record->next)
+    {
+      std::uint64_t local = record->epoch.load();
+      if (local != EPOCH_QUIESCENT && local != epoch)
+      {
+        return false;
+      }
+    }
+    globalEpoch_.store(epoch + 1);
+    return true;
+  }
+
+  inline void EpochDomain::freeRetired()
+  {
+    std::uint64_t epoch = globalEpoch_.load();
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < retired_.size(); i++)
+    {
+      if (retired_[i].epoch + 2 <= epoch)
+      {
+        retired_[i].deleter(retired_[i].object);
+      }
+      else
+      {
+        retired_[kept++] = retired_[i];
+      }
+    }
+    retired_.resize(kept);
+  }
+
+
+  inline EpochGuard::EpochGuard(bool pinned) : pinned_(pinned)
+  {
+    if (pinned_)
+    {
+      EpochDomain::instance().pin();
+    }
+  }
+
+  inline EpochGuard::EpochGuard(const EpochGuard& other) : EpochGuard(other.pinned_) {}
+
+  inline EpochGuard& EpochGuard::operator=(const EpochGuard& other)
+  {
+    if (other.pinned_ && !pinned_)
+    {
+      EpochDomain::instance().pin();
+    }
+    else if (!other.pinned_ && pinned_)
+    {
+      EpochDomain::instance().unpin();
+    }
+    pinned_ = other.pinned_;
+    return *this;
+  }
+
+  inline EpochGuard::~EpochGuard()
+  {
+    if (pinned_)
+    {
+      EpochDomain::instance().unpin();
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,745 @@
+#ifndef FLAT_HASH_MAP_H
+#define FLAT_HASH_MAP_H
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "FlatHashMapIterator.h"
+#include "HashMap.h"
+#include "ParallelFor.h"
+#include "Prefetch.h"
+
+
+template <class Key, class T, class Hash, class Allocator>
+class HashMap<Key, T, Hash, detail::FlatStorage, Allocator>
+{
+public:
+  using iterator = detail::FlatHashMapIterator<Key, T, Hash>;
+  using const_iterator = detail::ConstFlatHashMapIterator<Key, T, Hash>;
+
+  using PairType = detail::Pair<const Key, T>;
+  using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<PairType>;
+
+  HashMap(std::size_t bucketCount = 8, const Allocator& allocator = Allocator());
+  ~HashMap();
+  HashMap(const HashMap& table_) = delete;
+  HashMap(HashMap&& table_);
+  HashMap& operator=(const HashMap& src) = delete;
+  HashMap& operator=(HashMap&& src) noexcept;
+
+  void insert(const Key& key, const T& value = T());
+  void insert(Key&& key, T&& value);
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace(K&& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(const Key& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(Key&& key, Args&&... args);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(const Key& key, M&& value);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(Key&& key, M&& value);
+  template <class RandomIt>
+  void bulkLoad(RandomIt first, RandomIt last);
+  template <class RandomIt, class Make, class Merge>
+  void bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge);
+  iterator find(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  iterator find(const K& key);
+  template <class KeyIt, class OutputIt>
+  OutputIt findBatch(KeyIt first, KeyIt last, OutputIt out);
+  bool remove(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  bool remove(const K& key);
+  void clear();
+  void rehash(std::size_t count = 0);
+  void reserve(std::size_t count);
+  void shrinkToFit();
+  std::size_t size() const;
+  bool empty() const;
+  float loadFactor() const;
+  void setMaxLoadFactor(float maxLoadFactor);
+  void setMinLoadFactor(float minLoadFactor);
+  Allocator getAllocator() const;
+  void swap(HashMap& other) noexcept;
+#if defined(HASHMAP_ENABLE_STATS)
+  HashMapStats stats() const;
+#endif
+
+  iterator begin();
+  iterator end();
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+private:
+  std::size_t size_;
+  std::size_t deleted_;
+  std::size_t bucketCount_;
+  detail::ControlByte* ctrl_;
+  PairType* slots_;
+  float maxLoadFactor_;
+  float minLoadFactor_;
+  SlotAllocator allocator_;
+#if defined(HASHMAP_ENABLE_STATS)
+  detail::RehashCounters rehashCounters_;
+#endif
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> tryEmplaceImpl(K&& key, Args&&... args);
+  template <class K, class M>
+  std::pair<iterator, bool> insertOrAssignImpl(K&& key, M&& value);
+  template <class K, class... Args>
+  iterator insertNew(std::size_t hash, K&& key, Args&&... args);
+
+  template <class K>
+  iterator findImpl(const K& key);
+  template <class K>
+  bool removeImpl(const K& key);
+
+  template <class K>
+  std::size_t computeHash(const K& key) const;
+  std::size_t growthLimit(std::size_t bucketCount) const;
+  std::size_t bucketCountFor(std::size_t count) const;
+  void resize(std::size_t bucketCount);
+  void shrinkIfSparse();
+  template <class K>
+  std::size_t findSlot(const K& key, std::size_t hash) const;
+  std::size_t findFreeSlot(std::size_t hash) const;
+  void setCtrl(std::size_t index, detail::ControlByte ctrl);
+  void allocateSlots();
+  void destroySlots();
+};
+
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::HashMap(std::size_t initialBucketCount, const Allocator& allocator)
+  : size_(0), deleted_(0), bucketCount_(detail::MIN_BUCKET_COUNT), ctrl_(nullptr), slots_(nullptr),
+    maxLoadFactor_(detail::DEFAULT_MAX_LOAD_FACTOR), minLoadFactor_(detail::DEFAULT_MIN_LOAD_FACTOR),
+    allocator_(allocator)
+{
+  while (bucketCount_ < initialBucketCount)
+  {
+    bucketCount_ <<= 1;
+  }
+  allocateSlots();
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::~HashMap()
+{
+  destroySlots();
+  std::allocator_traits<SlotAllocator>::deallocate(allocator_, slots_, bucketCount_);
+  delete[] ctrl_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::HashMap(HashMap&& other) : HashMap(detail::MIN_BUCKET_COUNT, other.allocator_)
+{
+  swap(other);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+HashMap<Key, T, Hash, detail::FlatStorage, Allocator>& HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::operator=(HashMap&& other) noexcept
+{
+  if (this != &other)
+  {
+    swap(other);
+  }
+  return *this;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insert(const Key& key, const T& value)
+{
+  insertOrAssignImpl(key, value);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insert(Key&& key, T&& value)
+{
+  insertOrAssignImpl(std::move(key), std::move(value));
+}
+
+// With a transparent hash, a key of another type is looked up as it is and
+// only converted to Key if it has to be inserted.
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::emplace(K&& key, Args&&... args)
+{
+  if constexpr (std::is_same_v<std::decay_t<K>, Key> || detail::IsTransparent<Hash>::value)
+  {
+    return tryEmplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
+  }
+  else
+  {
+    return tryEmplaceImpl(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::tryEmplace(const Key& key, Args&&... args)
+{
+  return tryEmplaceImpl(key, std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::tryEmplace(Key&& key, Args&&... args)
+{
+  return tryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insertOrAssign(const Key& key, M&& value)
+{
+  return insertOrAssignImpl(key, std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insertOrAssign(Key&& key, M&& value)
+{
+  return insertOrAssignImpl(std::move(key), std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::tryEmplaceImpl(K&& key, Args&&... args)
+{
+  std::size_t hash = computeHash(key);
+  std::size_t index = findSlot(key, hash);
+  if (index != bucketCount_)
+  {
+    return { iterator(ctrl_ + index, ctrl_ + bucketCount_, slots_ + index), false };
+  }
+  return { insertNew(hash, std::forward<K>(key), std::forward<Args>(args)...), true };
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class M>
+std::pair<typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator, bool> HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insertOrAssignImpl(K&& key, M&& value)
+{
+  std::size_t hash = computeHash(key);
+  std::size_t index = findSlot(key, hash);
+  if (index != bucketCount_)
+  {
+    slots_[index].second = std::forward<M>(value);
+    return { iterator(ctrl_ + index, ctrl_ + bucketCount_, slots_ + index), false };
+  }
+  return { insertNew(hash, std::forward<K>(key), std::forward<M>(value)), true };
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class... Args>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::insertNew(std::size_t hash, K&& key, Args&&... args)
+{
+  if (size_ + deleted_ >= growthLimit(bucketCount_))
+  {
+    rehash();
+  }
+
+  std::size_t index = findFreeSlot(hash);
+  new (slots_ + index) PairType(std::in_place, std::forward<K>(key), std::forward<Args>(args)...);
+  if (ctrl_[index] == detail::CTRL_DELETED)
+  {
+    --deleted_;
+  }
+  setCtrl(index, detail::hashH2(hash));
+  ++size_;
+  return iterator(ctrl_ + index, ctrl_ + bucketCount_, slots_ + index);
+}
+
+// Same contract as the chained bulkLoad. Probe sequences run across any
+// partition of the slot array, so only sizing and hashing happen in parallel;
+// slots are then filled in input order.
+template <class Key, class T, class Hash, class Allocator>
+template <class RandomIt, class Make, class Merge>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge)
+{
+  std::size_t count = static_cast<std::size_t>(last - first);
+  if (count == 0)
+  {
+    return;
+  }
+
+  if (size_ + deleted_ + count >= growthLimit(bucketCount_))
+  {
+    std::size_t bucketCount = bucketCount_;
+    while (growthLimit(bucketCount) <= size_ + count)
+    {
+      bucketCount <<= 1;
+    }
+    rehash(bucketCount);
+  }
+
+  std::size_t threadCount = detail::bulkLoadThreads<Allocator>(count);
+  std::vector<std::size_t> hashes(count);
+  detail::parallelFor(threadCount, [&](std::size_t chunk)
+  {
+    for (std::size_t i = count * chunk / threadCount; i < count * (chunk + 1) / threadCount; i++)
+    {
+      hashes[i] = computeHash(first[i].first);
+    }
+  });
+
+  for (std::size_t i = 0; i < count; i++)
+  {
+    auto&& element = first[i];
+    std::size_t index = findSlot(element.first, hashes[i]);
+    if (index != bucketCount_)
+    {
+      merge(slots_[index].second, element);
+    }
+    else
+    {
+      insertNew(hashes[i], element.first, make(element));
+    }
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class RandomIt>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::bulkLoad(RandomIt first, RandomIt last)
+{
+  bulkLoad(first, last,
+    [](const auto& element) { return T(element.second); },
+    [](T& value, const auto& element) { value = element.second; });
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::find(const Key& key)
+{
+  return findImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::find(const K& key)
+{
+  return findImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::findImpl(const K& key)
+{
+  std::size_t index = findSlot(key, computeHash(key));
+  if (index == bucketCount_)
+  {
+    return end();
+  }
+  return iterator(ctrl_ + index, ctrl_ + bucketCount_, slots_ + index);
+}
+
+// Same contract as the chained findBatch: a block of keys is hashed and the
+// first control group and slot of every probe are prefetched before any of
+// them is resolved.
+template <class Key, class T, class Hash, class Allocator>
+template <class KeyIt, class OutputIt>
+OutputIt HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::findBatch(KeyIt first, KeyIt last, OutputIt out)
+{
+  std::size_t hashes[detail::FIND_BATCH_BLOCK];
+  while (first != last)
+  {
+    KeyIt blockFirst = first;
+    std::size_t count = 0;
+    for (; first != last && count < detail::FIND_BATCH_BLOCK; ++first, ++count)
+    {
+      hashes[count] = computeHash(*first);
+      std::size_t index = hashes[count] & (bucketCount_ - 1);
+      detail::prefetch(ctrl_ + index);
+      detail::prefetch(slots_ + index);
+    }
+
+    for (std::size_t i = 0; i < count; i++, ++blockFirst)
+    {
+      std::size_t index = findSlot(*blockFirst, hashes[i]);
+      *out++ = index == bucketCount_ ? end() : iterator(ctrl_ + index, ctrl_ + bucketCount_, slots_ + index);
+    }
+  }
+  return out;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+bool HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::remove(const Key& key)
+{
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K, class>
+bool HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::remove(const K& key)
+{
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+bool HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::removeImpl(const K& key)
+{
+  std::size_t index = findSlot(key, computeHash(key));
+  if (index == bucketCount_)
+  {
+    return false;
+  }
+
+  slots_[index].~PairType();
+
+  // A slot can go straight back to empty if no probe window covering it was
+  // ever completely full, because then no probe has ever continued past it.
+  bool wasNeverFull = bucketCount_ <= detail::Group::WIDTH;
+  if (!wasNeverFull)
+  {
+    auto emptyBefore = detail::Group(ctrl_ + ((index - detail::Group::WIDTH) & (bucketCount_ - 1))).matchEmpty();
+    auto emptyAfter = detail::Group(ctrl_ + index).matchEmpty();
+    wasNeverFull = emptyBefore && emptyAfter
+      && emptyAfter.lowest() + (detail::Group::WIDTH - 1 - emptyBefore.highest()) < detail::Group::WIDTH;
+  }
+
+  if (wasNeverFull)
+  {
+    setCtrl(index, detail::CTRL_EMPTY);
+  }
+  else
+  {
+    setCtrl(index, detail::CTRL_DELETED);
+    ++deleted_;
+  }
+  --size_;
+  shrinkIfSparse();
+  return true;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::clear()
+{
+  destroySlots();
+  std::fill(ctrl_, ctrl_ + bucketCount_ + detail::Group::WIDTH, detail::CTRL_EMPTY);
+  size_ = 0;
+  deleted_ = 0;
+  shrinkIfSparse();
+}
+
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::size() const
+{
+  return size_;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+bool HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::empty() const
+{
+  return size_ == 0;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+float HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::loadFactor() const
+{
+  return static_cast<float>(size_) / static_cast<float>(bucketCount_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::setMaxLoadFactor(float maxLoadFactor)
+{
+  if (maxLoadFactor < 0.05f || maxLoadFactor > 1.0f)
+  {
+    throw std::invalid_argument("Load factor must be greater than 0.05 and less than 1.");
+  }
+  if (maxLoadFactor < 2 * minLoadFactor_)
+  {
+    throw std::invalid_argument("Maximum load factor must be at least twice the minimum load factor.");
+  }
+  maxLoadFactor_ = maxLoadFactor;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::setMinLoadFactor(float minLoadFactor)
+{
+  if (minLoadFactor < 0.0f || 2 * minLoadFactor > maxLoadFactor_)
+  {
+    throw std::invalid_argument("Minimum load factor must be non-negative and at most half the maximum load factor.");
+  }
+  minLoadFactor_ = minLoadFactor;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+Allocator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::getAllocator() const
+{
+  return Allocator(allocator_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::swap(HashMap& other) noexcept
+{
+  std::swap(size_, other.size_);
+  std::swap(deleted_, other.deleted_);
+  std::swap(bucketCount_, other.bucketCount_);
+  std::swap(ctrl_, other.ctrl_);
+  std::swap(slots_, other.slots_);
+  std::swap(maxLoadFactor_, other.maxLoadFactor_);
+  std::swap(minLoadFactor_, other.minLoadFactor_);
+  std::swap(allocator_, other.allocator_);
+#if defined(HASHMAP_ENABLE_STATS)
+  std::swap(rehashCounters_, other.rehashCounters_);
+#endif
+}
+
+#if defined(HASHMAP_ENABLE_STATS)
+// Replays the probe sequence of every entry to find the group it landed in.
+template <class Key, class T, class Hash, class Allocator>
+HashMapStats HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::stats() const
+{
+  HashMapStats stats;
+  stats.size = size_;
+  stats.bucketCount = bucketCount_;
+  stats.deletedSlots = deleted_;
+  stats.emptyBuckets = bucketCount_ - size_ - deleted_;
+  stats.rehashCount = rehashCounters_.count;
+  stats.rehashSeconds = std::chrono::duration<double>(rehashCounters_.time).count();
+  stats.bucketBytes = bucketCount_ * sizeof(PairType) + (bucketCount_ + detail::Group::WIDTH) * sizeof(detail::ControlByte);
+
+  std::size_t mask = bucketCount_ - 1;
+  for (std::size_t i = 0; i < bucketCount_; i++)
+  {
+    if (!detail::isFull(ctrl_[i]))
+    {
+      continue;
+    }
+    std::size_t index = computeHash(slots_[i].first) & mask;
+    std::size_t step = 0;
+    std::size_t groups = 0;
+    while (((i - index) & mask) >= detail::Group::WIDTH)
+    {
+      step += detail::Group::WIDTH;
+      index = (index + step) & mask;
+      groups++;
+    }
+    stats.addLength(groups);
+    stats.elementBytes += detail::heapBytes(slots_[i].first) + detail::heapBytes(slots_[i].second);
+  }
+  return stats;
+}
+#endif
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::begin()
+{
+  return iterator(ctrl_, ctrl_ + bucketCount_, slots_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::end()
+{
+  return iterator(ctrl_ + bucketCount_, ctrl_ + bucketCount_, slots_ + bucketCount_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::const_iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::cbegin() const
+{
+  return const_iterator(ctrl_, ctrl_ + bucketCount_, slots_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+typename HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::const_iterator HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::cend() const
+{
+  return const_iterator(ctrl_ + bucketCount_, ctrl_ + bucketCount_, slots_ + bucketCount_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::computeHash(const K& key) const
+{
+  return detail::mixHash(Hash{}(key));
+}
+
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::growthLimit(std::size_t bucketCount) const
+{
+  // At least one slot always stays empty so that unsuccessful probes terminate.
+  std::size_t limit = static_cast<std::size_t>(bucketCount * maxLoadFactor_);
+  return limit < bucketCount ? limit : bucketCount - 1;
+}
+
+template <class Key, class T, class Hash, class Allocator>
+template <class K>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::findSlot(const K& key, std::size_t hash) const
+{
+  detail::ControlByte h2 = detail::hashH2(hash);
+  std::size_t mask = bucketCount_ - 1;
+  std::size_t index = hash & mask;
+  std::size_t step = 0;
+  while (true)
+  {
+    detail::Group group(ctrl_ + index);
+    for (auto match = group.match(h2); match; match.removeLowest())
+    {
+      std::size_t candidate = (index + match.lowest()) & mask;
+      if (slots_[candidate].first == key)
+      {
+        return candidate;
+      }
+    }
+    if (group.matchEmpty())
+    {
+      return bucketCount_;
+    }
+    step += detail::Group::WIDTH;
+    index = (index + step) & mask;
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::findFreeSlot(std::size_t hash) const
+{
+  std::size_t mask = bucketCount_ - 1;
+  std::size_t index = hash & mask;
+  std::size_t step = 0;
+  while (true)
+  {
+    auto match = detail::Group(ctrl_ + index).matchEmptyOrDeleted();
+    if (match)
+    {
+      return (index + match.lowest()) & mask;
+    }
+    step += detail::Group::WIDTH;
+    index = (index + step) & mask;
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::setCtrl(std::size_t index, detail::ControlByte ctrl)
+{
+  // The first WIDTH control bytes are mirrored past the end so that a group
+  // load starting near the end of the table wraps around without a branch.
+  ctrl_[index] = ctrl;
+  for (std::size_t clone = index + bucketCount_; clone < bucketCount_ + detail::Group::WIDTH; clone += bucketCount_)
+  {
+    ctrl_[clone] = ctrl;
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::allocateSlots()
+{
+  ctrl_ = new detail::ControlByte[bucketCount_ + detail::Group::WIDTH];
+  std::fill(ctrl_, ctrl_ + bucketCount_ + detail::Group::WIDTH, detail::CTRL_EMPTY);
+  slots_ = std::allocator_traits<SlotAllocator>::allocate(allocator_, bucketCount_);
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::destroySlots()
+{
+  for (std::size_t i = 0; i < bucketCount_; i++)
+  {
+    if (detail::isFull(ctrl_[i]))
+    {
+      slots_[i].~PairType();
+    }
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::rehash(std::size_t minSize)
+{
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount < minSize || growthLimit(bucketCount) <= size_)
+  {
+    bucketCount <<= 1;
+  }
+  resize(bucketCount);
+}
+
+// Sizes the table for count elements, or for size() if that is larger, in
+// either direction.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::reserve(std::size_t count)
+{
+  std::size_t bucketCount = bucketCountFor(count > size_ ? count : size_);
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::shrinkToFit()
+{
+  std::size_t bucketCount = bucketCountFor(size_);
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+// Smallest slot count that takes count elements without growing.
+template <class Key, class T, class Hash, class Allocator>
+std::size_t HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::bucketCountFor(std::size_t count) const
+{
+  std::size_t bucketCount = detail::MIN_BUCKET_COUNT;
+  while (growthLimit(bucketCount) < count)
+  {
+    bucketCount <<= 1;
+  }
+  return bucketCount;
+}
+
+// Halves the slot array until the load factor reaches the minimum.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::shrinkIfSparse()
+{
+  if (minLoadFactor_ == 0.0f)
+  {
+    return;
+  }
+
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount > detail::MIN_BUCKET_COUNT && size_ < bucketCount * minLoadFactor_)
+  {
+    bucketCount >>= 1;
+  }
+  if (bucketCount != bucketCount_)
+  {
+    resize(bucketCount);
+  }
+}
+
+// Moves every entry into a fresh slot array of bucketCount slots, which also
+// drops all tombstones.
+template <class Key, class T, class Hash, class Allocator>
+void HashMap<Key, T, Hash, detail::FlatStorage, Allocator>::resize(std::size_t bucketCount)
+{
+#if defined(HASHMAP_ENABLE_STATS)
+  rehashCounters_.count++;
+  detail::RehashTimer timer(rehashCounters_);
+#endif
+  std::size_t oldBucketCount = bucketCount_;
+  detail::ControlByte* oldCtrl = ctrl_;
+  PairType* oldSlots = slots_;
+
+  bucketCount_ = bucketCount;
+  allocateSlots();
+  deleted_ = 0;
+
+  for (std::size_t i = 0; i < oldBucketCount; i++)
+  {
+    if (detail::isFull(oldCtrl[i]))
+    {
+      std::size_t hash = computeHash(oldSlots[i].first);
+      std::size_t index = findFreeSlot(hash);
+      detail::relocatePair(slots_ + index, oldSlots[i]);
+      setCtrl(index, detail::hashH2(hash));
+    }
+  }
+
+  std::allocator_traits<SlotAllocator>::deallocate(allocator_, oldSlots, oldBucketCount);
+  delete[] oldCtrl;
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef FLAT_HASH_MAP_ITERATOR_H
+#define FLAT_HASH_MAP_ITERATOR_H
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+#include "ControlGroup.h"
+#include "Pair.h"
+
+namespace detail
+{
+  template <class Key, class T, class Hash, bool IsConst>
+  class FlatHashMapIteratorBase
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = detail::Pair<const Key, T>;
+    using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+    using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+
+    reference operator*() const;
+    pointer operator->() const;
+    FlatHashMapIteratorBase& operator++();
+    FlatHashMapIteratorBase operator++(int);
+    bool operator==(const FlatHashMapIteratorBase& other) const;
+    bool operator!=(const FlatHashMapIteratorBase& other) const;
+
+    FlatHashMapIteratorBase(const ControlByte* ctrlIt, const ControlByte* endCtrl, value_type* slotIt);
+
+  private:
+    const ControlByte* ctrlIt_;
+    const ControlByte* endCtrl_;
+    value_type* slotIt_;
+
+    void skipEmptySlots();
+  };
+
+  template <class Key, class T, class Hash>
+  using FlatHashMapIterator = FlatHashMapIteratorBase<Key, T, Hash, false>;
+
+  template <class Key, class T, class Hash>
+  using ConstFlatHashMapIterator = FlatHashMapIteratorBase<Key, T, Hash, true>;
+
+
+  template <class Key, class T, class Hash, bool IsConst>
+  FlatHashMapIteratorBase<Key, T, Hash, IsConst>::FlatHashMapIteratorBase(const ControlByte* ctrlIt,
+    const ControlByte* endCtrl, value_type* slotIt)
+    : ctrlIt_(ctrlIt), endCtrl_(endCtrl), slotIt_(slotIt)
+  {
+    skipEmptySlots();
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  typename FlatHashMapIteratorBase<Key, T, Hash, IsConst>::reference FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator*() const
+  {
+    assert(ctrlIt_ != endCtrl_);
+    return *slotIt_;
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  typename FlatHashMapIteratorBase<Key, T, Hash, IsConst>::pointer FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator->() const
+  {
+    assert(ctrlIt_ != endCtrl_);
+    return slotIt_;
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  FlatHashMapIteratorBase<Key, T, Hash, IsConst>& FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator++()
+  {
+    ++ctrlIt_;
+    ++slotIt_;
+    skipEmptySlots();
+    return *this;
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  FlatHashMapIteratorBase<Key, T, Hash, IsConst> FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator++(int)
+  {
+    FlatHashMapIteratorBase<Key, T, Hash, IsConst> temp = *this;
+    operator++();
+    return temp;
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  bool FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator==(const FlatHashMapIteratorBase<Key, T, Hash, IsConst>& other) const
+  {
+    return ctrlIt_ == other.ctrlIt_;
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  bool FlatHashMapIteratorBase<Key, T, Hash, IsConst>::operator!=(const FlatHashMapIteratorBase<Key, T, Hash, IsConst>& other) const
+  {
+    return !(*this == other);
+  }
+
+  template <class Key, class T, class Hash, bool IsConst>
+  void FlatHashMapIteratorBase<Key, T, Hash, IsConst>::skipEmptySlots()
+  {
+    while (ctrlIt_ != endCtrl_ && !isFull(*ctrlIt_))
+    {
+      ++ctrlIt_;
+      ++slotIt_;
+    }
+  }
+}
+
+#endif
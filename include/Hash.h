@@ -1,12 +1,163 @@
 #ifndef HASH_H
 #define HASH_H
 
+#include <cstdint>
+#include <cstring>
 #include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
 
 
 namespace detail
 {
+  static constexpr std::uint64_t HASH_SECRET[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull
+  };
+
+  inline std::uint64_t read64(const unsigned char* p)
+  {
+    std::uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  inline std::uint64_t read32(const unsigned char* p)
+  {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+#if defined(__SIZEOF_INT128__)
+  // __extension__ keeps -Wpedantic quiet about the non-standard type.
+  __extension__ typedef unsigned __int128 Uint128;
+#endif
+
+  // Full 64x64 -> 128 bit multiply; the low half goes to a, the high half to b.
+  inline void multiply128(std::uint64_t& a, std::uint64_t& b)
+  {
+#if defined(__SIZEOF_INT128__)
+    Uint128 product = static_cast<Uint128>(a) * b;
+    a = static_cast<std::uint64_t>(product);
+    b = static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    std::uint64_t ha = a >> 32, hb = b >> 32, la = static_cast<std::uint32_t>(a), lb = static_cast<std::uint32_t>(b);
+    std::uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    std::uint64_t t = rl + (rm0 << 32);
+    std::uint64_t carry = t < rl;
+    std::uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+#endif
+  }
+
+  inline std::uint64_t multiplyMix(std::uint64_t a, std::uint64_t b)
+  {
+    multiply128(a, b);
+    return a ^ b;
+  }
+
+  // wyhash-style hash: consumes 16 bytes per step (48 for long keys, in three
+  // independent lanes) and folds every step through a 128-bit multiply, so
+  // all output bits, including the low ones used as a bucket index, depend on
+  // every input byte.
+  inline std::uint64_t hashBytes(const void* data, std::size_t length, std::uint64_t seed = 0)
+  {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    seed ^= multiplyMix(seed ^ HASH_SECRET[0], HASH_SECRET[1]);
+
+    std::uint64_t a;
+    std::uint64_t b;
+    if (length <= 16)
+    {
+      if (length >= 4)
+      {
+        std::size_t offset = (length >> 3) << 2;
+        a = (read32(p) << 32) | read32(p + offset);
+        b = (read32(p + length - 4) << 32) | read32(p + length - 4 - offset);
+      }
+      else if (length > 0)
+      {
+        a = (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+        b = 0;
+      }
+      else
+      {
+        a = 0;
+        b = 0;
+      }
+    }
+    else
+    {
+      std::size_t remaining = length;
+      if (remaining > 48)
+      {
+        std::uint64_t lane1 = seed;
+        std::uint64_t lane2 = seed;
+        do
+        {
+          seed = multiplyMix(read64(p) ^ HASH_SECRET[1], read64(p + 8) ^ seed);
+          lane1 = multiplyMix(read64(p + 16) ^ HASH_SECRET[2], read64(p + 24) ^ lane1);
+          lane2 = multiplyMix(read64(p + 32) ^ HASH_SECRET[3], read64(p + 40) ^ lane2);
+          p += 48;
+          remaining -= 48;
+        } while (remaining > 48);
+        seed ^= lane1 ^ lane2;
+      }
+      while (remaining > 16)
+      {
+        seed = multiplyMix(read64(p) ^ HASH_SECRET[1], read64(p + 8) ^ seed);
+        p += 16;
+        remaining -= 16;
+      }
+      a = read64(p + remaining - 16);
+      b = read64(p + remaining - 8);
+    }
+
+    a ^= HASH_SECRET[1];
+    b ^= seed;
+    multiply128(a, b);
+    return multiplyMix(a ^ HASH_SECRET[0] ^ length, b ^ HASH_SECRET[1]);
+  }
+
   struct StringHash
+  {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const
+    {
+      return static_cast<size_t>(hashBytes(key.data(), key.size()));
+    }
+  };
+
+  // A hash that declares is_transparent hashes every type it accepts the same
+  // way as the equal Key, so lookups may pass any K that Key compares equal to
+  // with == (such as std::string_view for std::string) without converting it.
+  template <class Hash, class = void>
+  struct IsTransparent : std::false_type {};
+
+  template <class Hash>
+  struct IsTransparent<Hash, std::void_t<typename Hash::is_transparent>> : std::true_type {};
+
+  template <class Hash, class K>
+  using TransparentKey = std::enable_if_t<IsTransparent<Hash>::value, K>;
+
+  // Whether the chained HashMap keeps the full hash next to each entry. On by
+  // default for keys that are not cheap to hash and compare; specialize to
+  // override for a particular key or hash functor.
+  template <class Key, class Hash>
+  struct CacheHash : std::bool_constant<!std::is_scalar<Key>::value> {};
+
+  // Jenkins one-at-a-time. Kept out of line as the reference point for the
+  // hash benchmark.
+  struct OneAtATimeHash
   {
     size_t operator()(const std::string& key) const;
   };
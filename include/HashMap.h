@@ -1,40 +1,99 @@
 #ifndef HASH_MAP_H
 #define HASH_MAP_H
 
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "ChainBucket.h"
 #include "HashMapIterator.h"
-#include "LinkedList.h"
+#include "HashMapStats.h"
+#include "ParallelFor.h"
+#include "Prefetch.h"
 
 namespace detail
 {
   static float DEFAULT_MAX_LOAD_FACTOR = 0.66f;
+  static const float DEFAULT_MIN_LOAD_FACTOR = 0.0f;
+  static const std::size_t MIN_BUCKET_COUNT = 8;
+  static const std::size_t INCREMENTAL_REHASH_STEP = 4;
+  static const std::size_t FIND_BATCH_BLOCK = 16;
+
+  struct ChainedStorage {};
+  struct FlatStorage {};
+  struct DenseStorage {};
+
+  template <class Allocator, class = void>
+  struct HasRelease : std::false_type {};
+
+  template <class Allocator>
+  struct HasRelease<Allocator, std::void_t<decltype(std::declval<Allocator&>().release())>> : std::true_type {};
 }
 
-template <class Key, class T, class Hash = std::hash<Key>>
+template <class Key, class T, class Hash = std::hash<Key>, class Storage = detail::ChainedStorage,
+  class Allocator = std::allocator<detail::Pair<const Key, T>>>
 class HashMap
 {
 public:
-  using iterator = detail::HashMapIterator<Key, T, Hash>;
-  using const_iterator = detail::ConstHashMapIterator<Key, T, Hash>;
+  using iterator = detail::HashMapIterator<Key, T, Hash, Allocator>;
+  using const_iterator = detail::ConstHashMapIterator<Key, T, Hash, Allocator>;
 
   using PairType = detail::Pair<const Key, T>;
-  using BucketType = LinkedList<PairType>;
+  using EntryType = detail::MapEntry<Key, T, Hash>;
+  using BucketType = detail::ChainBucket<EntryType>;
+  using NodeType = typename BucketType::NodeType;
+  using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<NodeType>;
+  using BucketAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<BucketType>;
 
-  HashMap(std::size_t bucketCount = 8);
+  HashMap(std::size_t bucketCount = 8, const Allocator& allocator = Allocator());
   ~HashMap();
   HashMap(const HashMap& table_) = delete;
-  HashMap(HashMap&& table_) = delete;
+  HashMap(HashMap&& table_);
   HashMap& operator=(const HashMap& src) = delete;
-  HashMap& operator=(HashMap&& src) = delete;
+  HashMap& operator=(HashMap&& src) noexcept;
 
   void insert(const Key& key, const T& value = T());
+  void insert(Key&& key, T&& value);
+  template <class K, class... Args>
+  std::pair<iterator, bool> emplace(K&& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(const Key& key, Args&&... args);
+  template <class... Args>
+  std::pair<iterator, bool> tryEmplace(Key&& key, Args&&... args);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(const Key& key, M&& value);
+  template <class M>
+  std::pair<iterator, bool> insertOrAssign(Key&& key, M&& value);
+  template <class RandomIt>
+  void bulkLoad(RandomIt first, RandomIt last);
+  template <class RandomIt, class Make, class Merge>
+  void bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge);
   iterator find(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  iterator find(const K& key);
+  template <class KeyIt, class OutputIt>
+  OutputIt findBatch(KeyIt first, KeyIt last, OutputIt out);
   bool remove(const Key& key);
+  template <class K, class = detail::TransparentKey<Hash, K>>
+  bool remove(const K& key);
   void clear();
   void rehash(std::size_t count = 0);
+  void reserve(std::size_t count);
+  void shrinkToFit();
   std::size_t size() const;
   bool empty() const;
   float loadFactor() const;
   void setMaxLoadFactor(float maxLoadFactor);
+  void setMinLoadFactor(float minLoadFactor);
+  void setIncrementalRehash(bool enabled);
+  Allocator getAllocator() const;
+  void swap(HashMap& other) noexcept;
+#if defined(HASHMAP_ENABLE_STATS)
+  HashMapStats stats() const;
+#endif
 
   iterator begin();
   iterator end();
@@ -46,15 +105,68 @@ private:
   std::size_t bucketCount_;
   BucketType* buckets_;
   float maxLoadFactor_;
+  float minLoadFactor_;
+
+  // While an incremental rehash is in progress both bucket arrays are live and
+  // old buckets below migratedCount_ have already been moved to buckets_.
+  // Only inserting a new key or removing one moves buckets, so lookups, and
+  // tryEmplace() on a key that is already there, never invalidate iterators.
+  bool incrementalRehash_;
+  std::size_t oldBucketCount_;
+  std::size_t migratedCount_;
+  // Old buckets moved per insert or removal, sized by beginRehash() so the
+  // migration ends before inserts alone could make the table grow again.
+  std::size_t migrateStep_;
+  BucketType* oldBuckets_;
+
+  NodeAllocator allocator_;
+#if defined(HASHMAP_ENABLE_STATS)
+  detail::RehashCounters rehashCounters_;
+#endif
 
-  std::size_t computeHash(const Key& key) const;
+  template <class K, class... Args>
+  std::pair<iterator, bool> tryEmplaceImpl(K&& key, Args&&... args);
+  template <class K, class M>
+  std::pair<iterator, bool> insertOrAssignImpl(K&& key, M&& value);
+  template <class K, class... Args>
+  iterator insertNew(std::size_t hash, K&& key, Args&&... args);
+  template <class K>
+  iterator findImpl(const K& key);
+  template <class K>
+  iterator findWithHash(const K& key, std::size_t hash);
+  template <class K>
+  bool removeImpl(const K& key);
+
+  static constexpr bool CACHE_HASH = detail::CacheHash<Key, Hash>::value;
+  static std::size_t entryHash(const EntryType& entry);
+  template <class K>
+  static bool entryMatches(const EntryType& entry, const K& key, std::size_t hash);
+  template <class... Args>
+  void emplaceEntry(BucketType& bucket, std::size_t hash, Args&&... args);
+  template <class K>
+  bool removeEntry(BucketType& bucket, const K& key, std::size_t hash);
+  void clearBucket(BucketType& bucket);
+
+  BucketType* allocateBuckets(std::size_t count);
+  void deallocateBuckets(BucketType* buckets, std::size_t count);
+  BucketType* findOldBucket(std::size_t hash) const;
+  std::size_t grownBucketCount(std::size_t minSize) const;
+  std::size_t bucketCountFor(std::size_t count) const;
+  void resize(std::size_t bucketCount);
+  void shrinkIfSparse();
+  void beginRehash(std::size_t bucketCount);
+  void migrateBuckets(std::size_t count);
+  void finishRehash();
 };
 
 
-template <class Key, class T, class Hash>
-HashMap<Key, T, Hash>::HashMap(std::size_t initialBucketCount)
-  : bucketCount_(8), buckets_(nullptr), size_(0),
-    maxLoadFactor_(detail::DEFAULT_MAX_LOAD_FACTOR)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+HashMap<Key, T, Hash, Storage, Allocator>::HashMap(std::size_t initialBucketCount, const Allocator& allocator)
+  : bucketCount_(detail::MIN_BUCKET_COUNT), buckets_(nullptr), size_(0),
+    maxLoadFactor_(detail::DEFAULT_MAX_LOAD_FACTOR), minLoadFactor_(detail::DEFAULT_MIN_LOAD_FACTOR),
+    incrementalRehash_(false),
+    oldBucketCount_(0), migratedCount_(0), migrateStep_(detail::INCREMENTAL_REHASH_STEP), oldBuckets_(nullptr),
+    allocator_(allocator)
 {
   if (initialBucketCount < 0)
   {
@@ -65,43 +177,342 @@ HashMap<Key, T, Hash>::HashMap(std::size_t initialBucketCount)
   {
     bucketCount_ <<= 1;
   }
-  buckets_ = new BucketType[bucketCount_];
+  buckets_ = allocateBuckets(bucketCount_);
 }
 
-template <class Key, class T, class Hash>
-HashMap<Key, T, Hash>::~HashMap()
+template <class Key, class T, class Hash, class Storage, class Allocator>
+HashMap<Key, T, Hash, Storage, Allocator>::~HashMap()
 {
-  delete[] buckets_;
+  deallocateBuckets(buckets_, bucketCount_);
+  deallocateBuckets(oldBuckets_, oldBucketCount_);
 }
 
-template <class Key, class T, class Hash>
-void HashMap<Key, T, Hash>::insert(const Key& key, const T& value)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+HashMap<Key, T, Hash, Storage, Allocator>::HashMap(HashMap&& other) : HashMap(detail::MIN_BUCKET_COUNT, Allocator(other.allocator_))
 {
-  auto pair_it = find(key);
-  if (pair_it != end())
+  swap(other);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+HashMap<Key, T, Hash, Storage, Allocator>& HashMap<Key, T, Hash, Storage, Allocator>::operator=(HashMap&& other) noexcept
+{
+  if (this != &other)
+  {
+    swap(other);
+  }
+  return *this;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::insert(const Key& key, const T& value)
+{
+  insertOrAssignImpl(key, value);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::insert(Key&& key, T&& value)
+{
+  insertOrAssignImpl(std::move(key), std::move(value));
+}
+
+// With a transparent hash, a key of another type is looked up as it is and
+// only converted to Key if it has to be inserted.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::emplace(K&& key, Args&&... args)
+{
+  if constexpr (std::is_same_v<std::decay_t<K>, Key> || detail::IsTransparent<Hash>::value)
   {
-    pair_it->second = value;
+    return tryEmplaceImpl(std::forward<K>(key), std::forward<Args>(args)...);
   }
   else
   {
-    if (loadFactor() >= maxLoadFactor_)
+    return tryEmplaceImpl(Key(std::forward<K>(key)), std::forward<Args>(args)...);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::tryEmplace(const Key& key, Args&&... args)
+{
+  return tryEmplaceImpl(key, std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class... Args>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::tryEmplace(Key&& key, Args&&... args)
+{
+  return tryEmplaceImpl(std::move(key), std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::insertOrAssign(const Key& key, M&& value)
+{
+  return insertOrAssignImpl(key, std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class M>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::insertOrAssign(Key&& key, M&& value)
+{
+  return insertOrAssignImpl(std::move(key), std::forward<M>(value));
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class... Args>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::tryEmplaceImpl(K&& key, Args&&... args)
+{
+  std::size_t hash = Hash{}(key);
+  auto pair_it = findWithHash(key, hash);
+  if (pair_it != end())
+  {
+    return { pair_it, false };
+  }
+  migrateBuckets(migrateStep_);
+  return { insertNew(hash, std::forward<K>(key), std::forward<Args>(args)...), true };
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class M>
+std::pair<typename HashMap<Key, T, Hash, Storage, Allocator>::iterator, bool> HashMap<Key, T, Hash, Storage, Allocator>::insertOrAssignImpl(K&& key, M&& value)
+{
+  std::size_t hash = Hash{}(key);
+  auto pair_it = findWithHash(key, hash);
+  if (pair_it != end())
+  {
+    pair_it->second = std::forward<M>(value);
+    return { pair_it, false };
+  }
+  migrateBuckets(migrateStep_);
+  return { insertNew(hash, std::forward<K>(key), std::forward<M>(value)), true };
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class... Args>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::insertNew(std::size_t hash, K&& key, Args&&... args)
+{
+  if (loadFactor() >= maxLoadFactor_)
+  {
+    if (incrementalRehash_)
+    {
+      finishRehash();
+      beginRehash(grownBucketCount(0));
+    }
+    else
     {
       rehash();
     }
+  }
+
+  BucketType& bucket = buckets_[hash & (bucketCount_ - 1)];
+  emplaceEntry(bucket, hash, std::in_place, std::forward<K>(key), std::forward<Args>(args)...);
+  ++size_;
+  return iterator(&bucket, buckets_ + bucketCount_, bucket.begin());
+}
+
+// Inserts every element of [first, last); elements expose the key as .first.
+// The first occurrence of a key stores make(element), later occurrences and
+// keys already in the map are folded in with merge(value, element), always in
+// input order. The table is sized once up front, keys are hashed in parallel
+// and then partitioned by the high bits of their bucket index, so every
+// thread fills its own range of buckets without locking. make and merge run
+// concurrently for distinct keys.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class RandomIt, class Make, class Merge>
+void HashMap<Key, T, Hash, Storage, Allocator>::bulkLoad(RandomIt first, RandomIt last, Make make, Merge merge)
+{
+  std::size_t count = static_cast<std::size_t>(last - first);
+  if (count == 0)
+  {
+    return;
+  }
+
+  finishRehash();
+  if (size_ + count > bucketCount_ * maxLoadFactor_)
+  {
+    rehash(static_cast<std::size_t>((size_ + count) / maxLoadFactor_) + 1);
+  }
+
+  std::size_t threadCount = detail::bulkLoadThreads<Allocator>(count);
+  std::size_t partitionShift = 0;
+  while ((bucketCount_ >> partitionShift) > threadCount)
+  {
+    ++partitionShift;
+  }
+  auto chunkBegin = [count, threadCount](std::size_t chunk) { return count * chunk / threadCount; };
+
+  // Hash and count how many keys of each chunk fall into each partition.
+  std::vector<std::size_t> hashes(count);
+  std::vector<std::size_t> offsets(threadCount * threadCount, 0);
+  detail::parallelFor(threadCount, [&](std::size_t chunk)
+  {
+    for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); i++)
+    {
+      hashes[i] = Hash{}(first[i].first);
+      ++offsets[chunk * threadCount + ((hashes[i] & (bucketCount_ - 1)) >> partitionShift)];
+    }
+  });
 
-    BucketType& bucket = buckets_[computeHash(key)];
-    bucket.insert({ key, value });
-    ++size_;
+  // Stable counting sort: within a partition, elements keep input order.
+  std::vector<std::size_t> partitionBegin(threadCount + 1, 0);
+  std::size_t running = 0;
+  for (std::size_t partition = 0; partition < threadCount; partition++)
+  {
+    partitionBegin[partition] = running;
+    for (std::size_t chunk = 0; chunk < threadCount; chunk++)
+    {
+      std::size_t chunkCount = offsets[chunk * threadCount + partition];
+      offsets[chunk * threadCount + partition] = running;
+      running += chunkCount;
+    }
+  }
+  partitionBegin[threadCount] = running;
+
+  std::vector<std::size_t> order(count);
+  detail::parallelFor(threadCount, [&](std::size_t chunk)
+  {
+    for (std::size_t i = chunkBegin(chunk); i < chunkBegin(chunk + 1); i++)
+    {
+      order[offsets[chunk * threadCount + ((hashes[i] & (bucketCount_ - 1)) >> partitionShift)]++] = i;
+    }
+  });
+
+  std::vector<std::size_t> inserted(threadCount, 0);
+  auto commitSize = [this, &inserted]()
+  {
+    for (std::size_t partitionInserted : inserted)
+    {
+      size_ += partitionInserted;
+    }
+  };
+  try
+  {
+    detail::parallelFor(threadCount, [&](std::size_t partition)
+    {
+      for (std::size_t k = partitionBegin[partition]; k < partitionBegin[partition + 1]; k++)
+      {
+        std::size_t i = order[k];
+        auto&& element = first[i];
+        BucketType& bucket = buckets_[hashes[i] & (bucketCount_ - 1)];
+
+        auto it = bucket.begin();
+        while (it != bucket.end() && !entryMatches(*it, element.first, hashes[i]))
+        {
+          ++it;
+        }
+        if (it != bucket.end())
+        {
+          merge(it->second, element);
+        }
+        else
+        {
+          emplaceEntry(bucket, hashes[i], std::in_place, element.first, make(element));
+          ++inserted[partition];
+        }
+      }
+    });
+  }
+  catch (...)
+  {
+    commitSize();
+    throw;
   }
+  commitSize();
 }
 
-template <class Key, class T, class Hash>
-typename HashMap<Key, T, Hash>::iterator HashMap<Key, T, Hash>::find(const Key& key)
+// Bulk insert where the last value given for a key wins.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class RandomIt>
+void HashMap<Key, T, Hash, Storage, Allocator>::bulkLoad(RandomIt first, RandomIt last)
 {
-  BucketType& bucket = buckets_[computeHash(key)];
+  bulkLoad(first, last,
+    [](const auto& element) { return T(element.second); },
+    [](T& value, const auto& element) { value = element.second; });
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::find(const Key& key)
+{
+  return findImpl(key);
+}
+
+// Lookup by any key type the transparent Hash accepts, without building a Key.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::find(const K& key)
+{
+  return findImpl(key);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::findImpl(const K& key)
+{
+  return findWithHash(key, Hash{}(key));
+}
+
+// Looks up every key of [first, last) and writes one iterator per key to out
+// (end() for a miss). Keys are handled in blocks: the block is hashed and
+// its buckets prefetched, then the head nodes of those buckets (link, hash
+// and key) are prefetched, and only then are the chains walked, so the cache misses of a
+// block overlap instead of being paid one after another.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class KeyIt, class OutputIt>
+OutputIt HashMap<Key, T, Hash, Storage, Allocator>::findBatch(KeyIt first, KeyIt last, OutputIt out)
+{
+  std::size_t hashes[detail::FIND_BATCH_BLOCK];
+  while (first != last)
+  {
+    KeyIt blockFirst = first;
+    std::size_t count = 0;
+    for (; first != last && count < detail::FIND_BATCH_BLOCK; ++first, ++count)
+    {
+      hashes[count] = Hash{}(*first);
+      detail::prefetch(buckets_ + (hashes[count] & (bucketCount_ - 1)));
+    }
+
+    // The first compare reads the link and the cached hash at the front of
+    // the node and then the key; a node need not start on a line boundary,
+    // so the key's line is fetched as well.
+    for (std::size_t i = 0; i < count; i++)
+    {
+      BucketType& bucket = buckets_[hashes[i] & (bucketCount_ - 1)];
+      if (!bucket.empty())
+      {
+        detail::prefetch(bucket.head);
+        detail::prefetch(&bucket.head->data.first);
+      }
+    }
+
+    for (std::size_t i = 0; i < count; i++, ++blockFirst)
+    {
+      *out++ = findWithHash(*blockFirst, hashes[i]);
+    }
+  }
+  return out;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::findWithHash(const K& key, std::size_t hash)
+{
+  BucketType* oldBucket = findOldBucket(hash);
+  if (oldBucket != nullptr)
+  {
+    for (auto it = oldBucket->begin(); it != oldBucket->end(); it++)
+    {
+      if (entryMatches(*it, key, hash))
+      {
+        return iterator(oldBucket, oldBuckets_ + oldBucketCount_, it, buckets_, buckets_ + bucketCount_);
+      }
+    }
+  }
+
+  BucketType& bucket = buckets_[hash & (bucketCount_ - 1)];
   for (auto it = bucket.begin(); it != bucket.end(); it++)
   {
-    if (it->first == key)
+    if (entryMatches(*it, key, hash))
     {
       return iterator(&bucket, &buckets_[bucketCount_], it);
     }
@@ -109,112 +520,488 @@ typename HashMap<Key, T, Hash>::iterator HashMap<Key, T, Hash>::find(const Key&
   return end();
 }
 
-template <class Key, class T, class Hash>
-bool HashMap<Key, T, Hash>::remove(const Key& key)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool HashMap<Key, T, Hash, Storage, Allocator>::remove(const Key& key)
 {
-  BucketType& bucket = buckets_[computeHash(key)];
-  bool isRemoved = bucket.remove(PairType{ key, T() });
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K, class>
+bool HashMap<Key, T, Hash, Storage, Allocator>::remove(const K& key)
+{
+  return removeImpl(key);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K>
+bool HashMap<Key, T, Hash, Storage, Allocator>::removeImpl(const K& key)
+{
+  migrateBuckets(migrateStep_);
+
+  std::size_t hash = Hash{}(key);
+  BucketType* oldBucket = findOldBucket(hash);
+  bool isRemoved = oldBucket != nullptr && removeEntry(*oldBucket, key, hash);
+  if (!isRemoved)
+  {
+    isRemoved = removeEntry(buckets_[hash & (bucketCount_ - 1)], key, hash);
+  }
   if (isRemoved)
   {
     --size_;
+    shrinkIfSparse();
   }
   return isRemoved;
 }
 
-template <class Key, class T, class Hash>
-void HashMap<Key, T, Hash>::clear()
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::clear()
 {
   for (size_t i = 0; i < bucketCount_; i++)
   {
-    buckets_[i].clear();
+    clearBucket(buckets_[i]);
   }
+  deallocateBuckets(oldBuckets_, oldBucketCount_);
+  oldBuckets_ = nullptr;
   size_ = 0;
+
+  if constexpr (detail::HasRelease<Allocator>::value)
+  {
+    allocator_.release();
+  }
+  shrinkIfSparse();
 }
 
-template <class Key, class T, class Hash>
-std::size_t HashMap<Key, T, Hash>::size() const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t HashMap<Key, T, Hash, Storage, Allocator>::size() const
 {
   return size_;
 }
 
-template <class Key, class T, class Hash>
-bool HashMap<Key, T, Hash>::empty() const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+bool HashMap<Key, T, Hash, Storage, Allocator>::empty() const
 {
   return size_ == 0;
 }
 
-template <class Key, class T, class Hash>
-float HashMap<Key, T, Hash>::loadFactor() const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+float HashMap<Key, T, Hash, Storage, Allocator>::loadFactor() const
 {
   return static_cast<float>(size_) / static_cast<float>(bucketCount_);
 }
 
-template <class Key, class T, class Hash>
-void HashMap<Key, T, Hash>::setMaxLoadFactor(float maxLoadFactor)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::setMaxLoadFactor(float maxLoadFactor)
 {
   if (maxLoadFactor < 0.05f || maxLoadFactor > 1.0f)
   {
     throw std::invalid_argument("Load factor must be greater than 0.05 and less than 1.");
   }
+  if (maxLoadFactor < 2 * minLoadFactor_)
+  {
+    throw std::invalid_argument("Maximum load factor must be at least twice the minimum load factor.");
+  }
   maxLoadFactor_ = maxLoadFactor;
 }
 
-template <class Key, class T, class Hash>
-typename HashMap<Key, T, Hash>::iterator HashMap<Key, T, Hash>::begin()
+// Below the minimum load factor, remove() and clear() halve the bucket array.
+// Zero, the default, never shrinks. It may be at most half the maximum, so a
+// table that just shrank is not already due to grow.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::setMinLoadFactor(float minLoadFactor)
+{
+  if (minLoadFactor < 0.0f || 2 * minLoadFactor > maxLoadFactor_)
+  {
+    throw std::invalid_argument("Minimum load factor must be non-negative and at most half the maximum load factor.");
+  }
+  minLoadFactor_ = minLoadFactor;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::setIncrementalRehash(bool enabled)
 {
+  if (!enabled)
+  {
+    finishRehash();
+  }
+  incrementalRehash_ = enabled;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+Allocator HashMap<Key, T, Hash, Storage, Allocator>::getAllocator() const
+{
+  return Allocator(allocator_);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::swap(HashMap& other) noexcept
+{
+  std::swap(size_, other.size_);
+  std::swap(bucketCount_, other.bucketCount_);
+  std::swap(buckets_, other.buckets_);
+  std::swap(maxLoadFactor_, other.maxLoadFactor_);
+  std::swap(minLoadFactor_, other.minLoadFactor_);
+  std::swap(incrementalRehash_, other.incrementalRehash_);
+  std::swap(oldBucketCount_, other.oldBucketCount_);
+  std::swap(migratedCount_, other.migratedCount_);
+  std::swap(migrateStep_, other.migrateStep_);
+  std::swap(oldBuckets_, other.oldBuckets_);
+  std::swap(allocator_, other.allocator_);
+#if defined(HASHMAP_ENABLE_STATS)
+  std::swap(rehashCounters_, other.rehashCounters_);
+#endif
+}
+
+#if defined(HASHMAP_ENABLE_STATS)
+// Walks every bucket, including those an incremental rehash has yet to move.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+HashMapStats HashMap<Key, T, Hash, Storage, Allocator>::stats() const
+{
+  HashMapStats stats;
+  stats.size = size_;
+  stats.bucketCount = bucketCount_;
+  stats.rehashCount = rehashCounters_.count;
+  stats.rehashSeconds = std::chrono::duration<double>(rehashCounters_.time).count();
+  stats.bucketBytes = bucketCount_ * sizeof(BucketType);
+  if (oldBuckets_ != nullptr)
+  {
+    stats.bucketBytes += oldBucketCount_ * sizeof(BucketType);
+  }
+  stats.nodeBytes = size_ * sizeof(NodeType);
+
+  auto scan = [&stats](const BucketType* first, const BucketType* last)
+  {
+    for (const BucketType* bucket = first; bucket != last; ++bucket)
+    {
+      std::size_t length = 0;
+      for (auto it = bucket->cbegin(); it != bucket->cend(); ++it, ++length)
+      {
+        stats.elementBytes += detail::heapBytes(it->first) + detail::heapBytes(it->second);
+      }
+      stats.addLength(length);
+      if (length == 0)
+      {
+        stats.emptyBuckets++;
+      }
+    }
+  };
+  scan(buckets_, buckets_ + bucketCount_);
+  if (oldBuckets_ != nullptr)
+  {
+    scan(oldBuckets_ + migratedCount_, oldBuckets_ + oldBucketCount_);
+  }
+  return stats;
+}
+#endif
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::begin()
+{
+  if (oldBuckets_ != nullptr)
+  {
+    return iterator(oldBuckets_ + migratedCount_, oldBuckets_ + oldBucketCount_,
+      oldBuckets_[migratedCount_].begin(), buckets_, buckets_ + bucketCount_);
+  }
   return iterator(buckets_, buckets_ + bucketCount_, buckets_[0].begin());
 }
 
-template <class Key, class T, class Hash>
-typename HashMap<Key, T, Hash>::iterator HashMap<Key, T, Hash>::end()
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::iterator HashMap<Key, T, Hash, Storage, Allocator>::end()
 {
   return iterator(buckets_ + bucketCount_, buckets_ + bucketCount_, typename BucketType::iterator());
 }
 
-template <class Key, class T, class Hash>
-typename HashMap<Key, T, Hash>::const_iterator HashMap<Key, T, Hash>::cbegin() const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::const_iterator HashMap<Key, T, Hash, Storage, Allocator>::cbegin() const
 {
+  if (oldBuckets_ != nullptr)
+  {
+    return const_iterator(oldBuckets_ + migratedCount_, oldBuckets_ + oldBucketCount_,
+      oldBuckets_[migratedCount_].begin(), buckets_, buckets_ + bucketCount_);
+  }
   return const_iterator(buckets_, buckets_ + bucketCount_, buckets_[0].begin());
 }
 
-template <class Key, class T, class Hash>
-typename HashMap<Key, T, Hash>::const_iterator HashMap<Key, T, Hash>::cend() const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::const_iterator HashMap<Key, T, Hash, Storage, Allocator>::cend() const
 {
   return const_iterator(buckets_ + bucketCount_, buckets_ + bucketCount_, typename BucketType::iterator());
 }
 
-template <class Key, class T, class Hash>
-std::size_t HashMap<Key, T, Hash>::computeHash(const Key& key) const
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t HashMap<Key, T, Hash, Storage, Allocator>::entryHash(const EntryType& entry)
 {
-  return Hash{}(key) & (bucketCount_ - 1);
+  if constexpr (CACHE_HASH)
+  {
+    return entry.hash;
+  }
+  else
+  {
+    return Hash{}(entry.first);
+  }
 }
 
-template <class Key, class T, class Hash>
-void HashMap<Key, T, Hash>::rehash(std::size_t minSize)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K>
+bool HashMap<Key, T, Hash, Storage, Allocator>::entryMatches(const EntryType& entry, const K& key, std::size_t hash)
+{
+  if constexpr (CACHE_HASH)
+  {
+    return entry.hash == hash && entry.first == key;
+  }
+  else
+  {
+    return entry.first == key;
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class... Args>
+void HashMap<Key, T, Hash, Storage, Allocator>::emplaceEntry(BucketType& bucket, std::size_t hash, Args&&... args)
+{
+  NodeType* node = std::allocator_traits<NodeAllocator>::allocate(allocator_, 1);
+  try
+  {
+    if constexpr (CACHE_HASH)
+    {
+      new (node) NodeType(std::in_place, bucket.head, hash, std::forward<Args>(args)...);
+    }
+    else
+    {
+      new (node) NodeType(std::in_place, bucket.head, std::forward<Args>(args)...);
+    }
+  }
+  catch (...)
+  {
+    std::allocator_traits<NodeAllocator>::deallocate(allocator_, node, 1);
+    throw;
+  }
+  bucket.head = node;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+template <class K>
+bool HashMap<Key, T, Hash, Storage, Allocator>::removeEntry(BucketType& bucket, const K& key, std::size_t hash)
+{
+  for (NodeType** link = &bucket.head; *link != nullptr; link = &(*link)->next)
+  {
+    NodeType* node = *link;
+    if (entryMatches(node->data, key, hash))
+    {
+      *link = node->next;
+      node->~NodeType();
+      std::allocator_traits<NodeAllocator>::deallocate(allocator_, node, 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::clearBucket(BucketType& bucket)
+{
+  while (!bucket.empty())
+  {
+    NodeType* node = bucket.extractFront();
+    node->~NodeType();
+    std::allocator_traits<NodeAllocator>::deallocate(allocator_, node, 1);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::BucketType* HashMap<Key, T, Hash, Storage, Allocator>::findOldBucket(std::size_t hash) const
+{
+  if (oldBuckets_ == nullptr)
+  {
+    return nullptr;
+  }
+  std::size_t index = hash & (oldBucketCount_ - 1);
+  return index < migratedCount_ ? nullptr : oldBuckets_ + index;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::rehash(std::size_t minSize)
 {
   if (minSize < 0)
   {
     throw std::invalid_argument("Minimum size for rehash must be non-negative.");
   }
 
-  std::size_t oldBucketCount = bucketCount_;
-  BucketType* oldBuckets = buckets_;
+  finishRehash();
+  beginRehash(grownBucketCount(minSize));
+  finishRehash();
+}
+
+// Sizes the table for count elements, or for size() if that is larger, in
+// either direction.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::reserve(std::size_t count)
+{
+  resize(bucketCountFor(count > size_ ? count : size_));
+}
 
-  while (bucketCount_ < minSize || bucketCount_ < size_ / maxLoadFactor_)
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::shrinkToFit()
+{
+  resize(bucketCountFor(size_));
+}
+
+// Smallest bucket count, starting from the current one, that has minSize
+// buckets and keeps the load factor below the maximum.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t HashMap<Key, T, Hash, Storage, Allocator>::grownBucketCount(std::size_t minSize) const
+{
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount < minSize || size_ >= bucketCount * maxLoadFactor_)
   {
-    bucketCount_ <<= 1;
+    bucketCount <<= 1;
+  }
+  return bucketCount;
+}
+
+// Smallest bucket count that takes count elements without growing.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+std::size_t HashMap<Key, T, Hash, Storage, Allocator>::bucketCountFor(std::size_t count) const
+{
+  std::size_t bucketCount = detail::MIN_BUCKET_COUNT;
+  while (bucketCount < count / maxLoadFactor_)
+  {
+    bucketCount <<= 1;
+  }
+  return bucketCount;
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::resize(std::size_t bucketCount)
+{
+  finishRehash();
+  if (bucketCount != bucketCount_)
+  {
+    beginRehash(bucketCount);
+    finishRehash();
+  }
+}
+
+// Halves the bucket array until the load factor reaches the minimum. With
+// incremental rehash the entries then move over in steps, as they do when
+// the table grows, and no further shrink starts until they have; the table
+// is only halved as far as leaves room for those steps.
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::shrinkIfSparse()
+{
+  if (minLoadFactor_ == 0.0f || oldBuckets_ != nullptr)
+  {
+    return;
+  }
+
+  std::size_t bucketCount = bucketCount_;
+  while (bucketCount > detail::MIN_BUCKET_COUNT && size_ < bucketCount * minLoadFactor_)
+  {
+    bucketCount >>= 1;
+  }
+  if (incrementalRehash_)
+  {
+    // Keep a quarter of the room below the maximum load free, so the
+    // migration can be spread over the inserts that may follow.
+    while (bucketCount < bucketCount_ && size_ * 4 > bucketCount * maxLoadFactor_ * 3)
+    {
+      bucketCount <<= 1;
+    }
+  }
+  if (bucketCount == bucketCount_)
+  {
+    return;
   }
-  buckets_ = new BucketType[bucketCount_];
 
-  for (size_t i = 0; i < oldBucketCount; i++)
+  if (incrementalRehash_)
   {
-    for (auto& pair : oldBuckets[i])
+    beginRehash(bucketCount);
+  }
+  else
+  {
+    resize(bucketCount);
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::beginRehash(std::size_t bucketCount)
+{
+#if defined(HASHMAP_ENABLE_STATS)
+  rehashCounters_.count++;
+  detail::RehashTimer timer(rehashCounters_);
+#endif
+  oldBucketCount_ = bucketCount_;
+  oldBuckets_ = buckets_;
+  migratedCount_ = 0;
+
+  bucketCount_ = bucketCount;
+  buckets_ = allocateBuckets(bucketCount_);
+
+  // Inserts the new table takes before it is full, counting the one that may
+  // be starting this rehash.
+  std::size_t limit = static_cast<std::size_t>(bucketCount_ * maxLoadFactor_);
+  std::size_t headroom = limit > size_ + 1 ? limit - size_ - 1 : 1;
+  migrateStep_ = std::max(detail::INCREMENTAL_REHASH_STEP, (oldBucketCount_ + headroom - 1) / headroom);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::migrateBuckets(std::size_t count)
+{
+#if defined(HASHMAP_ENABLE_STATS)
+  if (oldBuckets_ == nullptr)
+  {
+    return;
+  }
+  detail::RehashTimer timer(rehashCounters_);
+#endif
+  for (; oldBuckets_ != nullptr && count > 0; --count)
+  {
+    BucketType& oldBucket = oldBuckets_[migratedCount_++];
+    while (!oldBucket.empty())
     {
-      buckets_[computeHash(pair.first)].insert(pair);
+      NodeType* node = oldBucket.extractFront();
+      buckets_[entryHash(node->data) & (bucketCount_ - 1)].spliceFront(node);
     }
+
+    if (migratedCount_ == oldBucketCount_)
+    {
+      deallocateBuckets(oldBuckets_, oldBucketCount_);
+      oldBuckets_ = nullptr;
+    }
+  }
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::finishRehash()
+{
+  migrateBuckets(oldBucketCount_);
+}
+
+template <class Key, class T, class Hash, class Storage, class Allocator>
+typename HashMap<Key, T, Hash, Storage, Allocator>::BucketType* HashMap<Key, T, Hash, Storage, Allocator>::allocateBuckets(std::size_t count)
+{
+  BucketAllocator bucketAllocator(allocator_);
+  BucketType* buckets = std::allocator_traits<BucketAllocator>::allocate(bucketAllocator, count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    new (buckets + i) BucketType();
   }
+  return buckets;
+}
 
-  delete[] oldBuckets;
+template <class Key, class T, class Hash, class Storage, class Allocator>
+void HashMap<Key, T, Hash, Storage, Allocator>::deallocateBuckets(BucketType* buckets, std::size_t count)
+{
+  if (buckets == nullptr)
+  {
+    return;
+  }
+  for (std::size_t i = 0; i < count; i++)
+  {
+    clearBucket(buckets[i]);
+  }
+  BucketAllocator bucketAllocator(allocator_);
+  std::allocator_traits<BucketAllocator>::deallocate(bucketAllocator, buckets, count);
 }
 
 #endif
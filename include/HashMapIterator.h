@@ -4,17 +4,22 @@
 #include <cassert>
 #include <cstddef>
 #include <iterator>
+#include <type_traits>
 
+#include "ChainBucket.h"
 #include "Hash.h"
 #include "Pair.h"
-#include "LinkedList.h"
 
-template <class Key, class T, class Hash>
+template <class Key, class T, class Hash, class Storage, class Allocator>
 class HashMap;
 
 namespace detail
 {
-  template <class Key, class T, class Hash, bool IsConst>
+  // Element type stored in the chained buckets.
+  template <class Key, class T, class Hash>
+  using MapEntry = std::conditional_t<CacheHash<Key, Hash>::value, HashedPair<const Key, T>, Pair<const Key, T>>;
+
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
   class HashMapIteratorBase
   {
   public:
@@ -24,7 +29,7 @@ namespace detail
     using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
     using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
 
-    using BucketType = LinkedList<value_type>;
+    using BucketType = ChainBucket<MapEntry<Key, T, Hash>>;
 
     reference operator*() const;
     pointer operator->() const;
@@ -34,81 +39,102 @@ namespace detail
     bool operator!=(const HashMapIteratorBase& other) const;
 
     HashMapIteratorBase(BucketType* bucketIt, BucketType* endBucket,
-      typename BucketType::iterator entryIt);
+      typename BucketType::iterator entryIt,
+      BucketType* nextBucket = nullptr, BucketType* nextEndBucket = nullptr);
 
   private:
     BucketType* bucketIt_;
     BucketType* endBucket_;
     typename BucketType::iterator entryIt_;
 
+    // Second bucket range visited after the first one is exhausted; used while
+    // an incremental rehash keeps two bucket arrays alive.
+    BucketType* nextBucket_;
+    BucketType* nextEndBucket_;
+
     void skipEmptyBuckets();
   };
 
-  template <class Key, class T, class Hash>
-  using HashMapIterator = HashMapIteratorBase<Key, T, Hash, false>;
+  template <class Key, class T, class Hash, class Allocator>
+  using HashMapIterator = HashMapIteratorBase<Key, T, Hash, Allocator, false>;
 
-  template <class Key, class T, class Hash>
-  using ConstHashMapIterator = HashMapIteratorBase<Key, T, Hash, true>;
+  template <class Key, class T, class Hash, class Allocator>
+  using ConstHashMapIterator = HashMapIteratorBase<Key, T, Hash, Allocator, true>;
 
 
-  template <class Key, class T, class Hash, bool IsConst>
-  HashMapIteratorBase<Key, T, Hash, IsConst>::HashMapIteratorBase(BucketType* bucketIt,
-    BucketType* endBucket, typename BucketType::iterator entryIt)
-    : bucketIt_(bucketIt), endBucket_(endBucket), entryIt_(entryIt)
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::HashMapIteratorBase(BucketType* bucketIt,
+    BucketType* endBucket, typename BucketType::iterator entryIt,
+    BucketType* nextBucket, BucketType* nextEndBucket)
+    : bucketIt_(bucketIt), endBucket_(endBucket), entryIt_(entryIt),
+      nextBucket_(nextBucket), nextEndBucket_(nextEndBucket)
   {
     skipEmptyBuckets();
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  typename HashMapIteratorBase<Key, T, Hash, IsConst>::reference HashMapIteratorBase<Key, T, Hash, IsConst>::operator*() const
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  typename HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::reference HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator*() const
   {
     return *entryIt_;
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  typename HashMapIteratorBase<Key, T, Hash, IsConst>::pointer HashMapIteratorBase<Key, T, Hash, IsConst>::operator->() const
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  typename HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::pointer HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator->() const
   {
     return &(*entryIt_);
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  HashMapIteratorBase<Key, T, Hash, IsConst>& HashMapIteratorBase<Key, T, Hash, IsConst>::operator++()
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>& HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator++()
   {
     ++entryIt_;
     skipEmptyBuckets();
     return *this;
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  HashMapIteratorBase<Key, T, Hash, IsConst> HashMapIteratorBase<Key, T, Hash, IsConst>::operator++(int)
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  HashMapIteratorBase<Key, T, Hash, Allocator, IsConst> HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator++(int)
   {
-    HashMapIteratorBase<Key, T, Hash, IsConst> temp = *this;
+    HashMapIteratorBase<Key, T, Hash, Allocator, IsConst> temp = *this;
     operator++();
     return temp;
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  bool HashMapIteratorBase<Key, T, Hash, IsConst>::operator==(const HashMapIteratorBase<Key, T, Hash, IsConst>& other) const
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  bool HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator==(const HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>& other) const
   {
     return bucketIt_ == other.bucketIt_ && entryIt_ == other.entryIt_;
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  bool HashMapIteratorBase<Key, T, Hash, IsConst>::operator!=(const HashMapIteratorBase<Key, T, Hash, IsConst>& other) const
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  bool HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::operator!=(const HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>& other) const
   {
     return !(*this == other);
   }
 
-  template <class Key, class T, class Hash, bool IsConst>
-  void HashMapIteratorBase<Key, T, Hash, IsConst>::skipEmptyBuckets()
+  template <class Key, class T, class Hash, class Allocator, bool IsConst>
+  void HashMapIteratorBase<Key, T, Hash, Allocator, IsConst>::skipEmptyBuckets()
   {
-    while (bucketIt_ != endBucket_ && entryIt_ == bucketIt_->end())
+    while (true)
     {
-      ++bucketIt_;
-      if (bucketIt_ != endBucket_)
+      while (bucketIt_ != endBucket_ && entryIt_ == bucketIt_->end())
+      {
+        ++bucketIt_;
+        if (bucketIt_ != endBucket_)
+        {
+          entryIt_ = bucketIt_->begin();
+        }
+      }
+
+      if (bucketIt_ != endBucket_ || nextBucket_ == nullptr)
       {
-        entryIt_ = bucketIt_->begin();
+        return;
       }
+      bucketIt_ = nextBucket_;
+      endBucket_ = nextEndBucket_;
+      entryIt_ = bucketIt_->begin();
+      nextBucket_ = nullptr;
+      nextEndBucket_ = nullptr;
     }
   }
 }
@@ -0,0 +1,122 @@
+#ifndef HASH_MAP_STATS_H
+#define HASH_MAP_STATS_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "LinkedList.h"
+#include "SmallSortedSet.h"
+
+// HashMap::stats() only exists when the library is built with
+// HASHMAP_ENABLE_STATS defined (the HASHMAP_ENABLE_STATS CMake option).
+// Everything but the rehash counters is gathered by a scan at the time of the
+// call, so maps built without it carry no extra state and no extra work.
+
+namespace detail
+{
+  static const std::size_t STATS_HISTOGRAM_SIZE = 16;
+
+  // Heap bytes owned by a key or value on top of its own footprint.
+  template <class T>
+  std::size_t heapBytes(const T&)
+  {
+    return 0;
+  }
+
+  inline std::size_t heapBytes(const std::string& value)
+  {
+    // Short strings keep their characters inside the object.
+    const char* object = reinterpret_cast<const char*>(&value);
+    bool isLocal = value.data() >= object && value.data() < object + sizeof(value);
+    return isLocal ? 0 : value.capacity() + 1;
+  }
+
+  template <class T, class Allocator>
+  std::size_t heapBytes(const LinkedList<T, Allocator>& list)
+  {
+    std::size_t bytes = list.size() * sizeof(typename LinkedList<T, Allocator>::NodeType);
+    for (auto it = list.cbegin(); it != list.cend(); ++it)
+    {
+      bytes += heapBytes(*it);
+    }
+    return bytes;
+  }
+
+  template <class T, class Allocator>
+  std::size_t heapBytes(const SortedUniqueList<T, Allocator>& list)
+  {
+    return heapBytes(static_cast<const LinkedList<T, Allocator>&>(list));
+  }
+
+  template <class T, std::size_t InlineCount, class Allocator>
+  std::size_t heapBytes(const SmallSortedSet<T, InlineCount, Allocator>& set)
+  {
+    std::size_t bytes = set.isInline() ? 0 : set.capacity() * sizeof(T);
+    for (const T& value : set)
+    {
+      bytes += heapBytes(value);
+    }
+    return bytes;
+  }
+
+  // Rehashes done by a map so far and the time spent in them.
+  struct RehashCounters
+  {
+    std::size_t count = 0;
+    std::chrono::steady_clock::duration time{};
+  };
+
+  // Adds the lifetime of the timer to counters.time.
+  class RehashTimer
+  {
+  public:
+    explicit RehashTimer(RehashCounters& counters) : counters_(counters), start_(std::chrono::steady_clock::now()) {}
+    ~RehashTimer() { counters_.time += std::chrono::steady_clock::now() - start_; }
+    RehashTimer(const RehashTimer&) = delete;
+    RehashTimer& operator=(const RehashTimer&) = delete;
+
+  private:
+    RehashCounters& counters_;
+    std::chrono::steady_clock::time_point start_;
+  };
+}
+
+// Shape and memory of one HashMap. For chained storage a length is the number
+// of entries in a bucket and the histogram counts buckets; for flat storage it
+// is how many groups past its home group an entry was placed and the histogram
+// counts entries. The last histogram cell also counts every longer length.
+struct HashMapStats
+{
+  std::size_t size = 0;
+  std::size_t bucketCount = 0;
+  std::size_t emptyBuckets = 0;
+  std::size_t deletedSlots = 0;
+  std::size_t maxLength = 0;
+  std::size_t lengthHistogram[detail::STATS_HISTOGRAM_SIZE] = {};
+
+  std::size_t rehashCount = 0;
+  double rehashSeconds = 0;
+
+  // Bucket arrays (or slot and control arrays), list nodes, and whatever the
+  // keys and values allocate themselves: string buffers, translation lists.
+  std::size_t bucketBytes = 0;
+  std::size_t nodeBytes = 0;
+  std::size_t elementBytes = 0;
+
+  void addLength(std::size_t length)
+  {
+    lengthHistogram[length < detail::STATS_HISTOGRAM_SIZE ? length : detail::STATS_HISTOGRAM_SIZE - 1]++;
+    if (length > maxLength)
+    {
+      maxLength = length;
+    }
+  }
+
+  std::size_t totalBytes() const
+  {
+    return bucketBytes + nodeBytes + elementBytes;
+  }
+};
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef INTERNED_DICTIONARY_H
+#define INTERNED_DICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include "Dictionary.h"
+#include "SmallSortedSet.h"
+#include "StringPool.h"
+
+namespace detail
+{
+  // Ids are four bytes, so a few of them cost less inline than a pointer to
+  // a spilled block does.
+  static const std::size_t INLINE_TRANSLATION_IDS = 4;
+
+  // Slot of a string id that is not a word with translations.
+  static const std::uint32_t NO_WORD_SLOT = UINT32_MAX;
+}
+
+
+// Translations of one word, resolved through the pool on access. Valid until
+// the dictionary is next modified.
+class InternedTranslations
+{
+public:
+  class const_iterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = std::string_view;
+    using reference = std::string_view;
+    using pointer = void;
+
+    const_iterator(const StringId* id, const StringPool* pool) : id_(id), pool_(pool) {}
+
+    std::string_view operator*() const { return pool_->view(*id_); }
+    const_iterator& operator++() { ++id_; return *this; }
+    const_iterator operator++(int) { const_iterator temp = *this; ++id_; return temp; }
+    bool operator==(const const_iterator& other) const { return id_ == other.id_; }
+    bool operator!=(const const_iterator& other) const { return id_ != other.id_; }
+
+  private:
+    const StringId* id_;
+    const StringPool* pool_;
+  };
+
+  InternedTranslations() : ids_(nullptr), count_(0), pool_(nullptr) {}
+  InternedTranslations(const StringId* ids, std::size_t count, const StringPool* pool)
+    : ids_(ids), count_(count), pool_(pool) {}
+
+  bool empty() const { return count_ == 0; }
+  std::size_t size() const { return count_; }
+  std::string_view operator[](std::size_t index) const { return pool_->view(ids_[index]); }
+  const_iterator begin() const { return const_iterator(ids_, pool_); }
+  const_iterator end() const { return const_iterator(ids_ + count_, pool_); }
+
+private:
+  const StringId* ids_;
+  std::size_t count_;
+  const StringPool* pool_;
+};
+
+
+// Dictionary that keeps every word and translation once in a StringPool. Ids
+// are dense, so a four-byte slot at index wordId leads to the word's entry,
+// a small sorted set of translation ids, and a lookup is a single probe of
+// the pool's index. Entries are packed and exist for words only, so a string
+// that is only ever a translation costs its slot and nothing more. A
+// translation shared by many words costs one pool entry plus four bytes per
+// word, and comparing translations is an integer compare. Translations are
+// ordered by id, which is the order they were first seen, not
+// alphabetically. Strings stay in the pool after their last use is removed,
+// until clear().
+class InternedDictionary
+{
+public:
+  using TranslationIds = SmallSortedSet<StringId, detail::INLINE_TRANSLATION_IDS>;
+
+  explicit InternedDictionary(std::size_t capacity = 8);
+
+  void insert(std::string_view word, std::string_view translation);
+  void remove(std::string_view word, std::string_view translation);
+  InternedTranslations find(std::string_view word) const;
+  bool contains(std::string_view word) const;
+  template <class F>
+  void forEach(F&& f) const;
+  void clear();
+  std::size_t size() const;
+  bool empty() const;
+  const StringPool& strings() const;
+
+private:
+  StringPool pool_;
+  // Slot of every string id that is a word; the word at a slot is words_[slot]
+  // and its translations are translations_[slot].
+  std::vector<std::uint32_t> slots_;
+  std::vector<StringId> words_;
+  std::vector<TranslationIds> translations_;
+
+  const TranslationIds* findTranslations(std::string_view word) const;
+};
+
+
+// Calls f(word, translations) for every entry.
+template <class F>
+void InternedDictionary::forEach(F&& f) const
+{
+  for (std::size_t slot = 0; slot < words_.size(); slot++)
+  {
+    const TranslationIds& ids = translations_[slot];
+    f(pool_.view(words_[slot]), InternedTranslations(ids.begin(), ids.size(), &pool_));
+  }
+}
+
+#endif
@@ -1,20 +1,33 @@
 #ifndef LINKED_LIST_H
 #define LINKED_LIST_H
 
+#include <memory>
+#include <utility>
+
 #include "LinkedListIterator.h"
 #include "ListNode.h"
 
+namespace detail
+{
+  template <class T, class Allocator>
+  using ListNodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<ListNode<T>>;
+}
+
 
-template <class T>
-class LinkedList
+template <class T, class Allocator = std::allocator<T>>
+class LinkedList : private detail::ListNodeAllocator<T, Allocator>
 {
 public:
   using iterator = detail::ListIterator<T>;
   using const_iterator = detail::ConstListIterator<T>;
 
+  using value_type = T;
+  using allocator_type = Allocator;
   using NodeType = detail::ListNode<T>;
+  using NodeAllocator = detail::ListNodeAllocator<T, Allocator>;
 
   LinkedList();
+  explicit LinkedList(const Allocator& allocator);
   ~LinkedList();
   LinkedList(const LinkedList& other);
   LinkedList& operator=(const LinkedList& other);
@@ -22,11 +35,17 @@ public:
   LinkedList& operator=(LinkedList&& other) noexcept;
 
   bool insert(const T& data);
+  bool insert(T&& data);
+  template <class... Args>
+  T& emplace(Args&&... args);
   bool remove(const T& data);
+  template <class Predicate>
+  bool removeFirstIf(Predicate pred);
   void clear();
   bool empty() const;
   T& front();
   size_t size() const;
+  Allocator getAllocator() const;
 
   iterator begin();
   iterator end();
@@ -36,40 +55,59 @@ public:
 protected:
   size_t size_;
   NodeType* head_;
+
+  template <class... Args>
+  NodeType* createNode(NodeType* next, Args&&... args);
+  void destroyNode(NodeType* node);
+  void swap(LinkedList& other) noexcept;
 };
 
 
-template <class T>
-class SortedUniqueList : public LinkedList<T>
+template <class T, class Allocator = std::allocator<T>>
+class SortedUniqueList : public LinkedList<T, Allocator>
 {
 public:
-  using iterator = typename LinkedList<T>::iterator;
-  using const_iterator = typename LinkedList<T>::const_iterator;
+  using iterator = typename LinkedList<T, Allocator>::iterator;
+  using const_iterator = typename LinkedList<T, Allocator>::const_iterator;
 
-  using BaseType = LinkedList<T>;
-  using NodeType = typename LinkedList<T>::NodeType;
+  using BaseType = LinkedList<T, Allocator>;
+  using NodeType = typename LinkedList<T, Allocator>::NodeType;
 
   SortedUniqueList();
+  explicit SortedUniqueList(const Allocator& allocator);
   SortedUniqueList(const SortedUniqueList& other);
   SortedUniqueList& operator=(const SortedUniqueList& other);
   SortedUniqueList(SortedUniqueList&& other) noexcept;
   SortedUniqueList& operator=(SortedUniqueList&& other) noexcept;
 
   bool insert(const T& data);
+  bool insert(T&& data);
+  template <class... Args>
+  bool emplace(Args&&... args);
+
+private:
+  template <class U>
+  bool insertSorted(U&& data);
 };
 
 
-template <class T>
-LinkedList<T>::LinkedList() : head_(nullptr), size_(0) {}
+template <class T, class Allocator>
+LinkedList<T, Allocator>::LinkedList() : head_(nullptr), size_(0) {}
 
-template <class T>
-LinkedList<T>::~LinkedList()
+template <class T, class Allocator>
+LinkedList<T, Allocator>::LinkedList(const Allocator& allocator)
+  : NodeAllocator(allocator), head_(nullptr), size_(0) {}
+
+template <class T, class Allocator>
+LinkedList<T, Allocator>::~LinkedList()
 {
   clear();
 }
 
-template <typename T>
-LinkedList<T>::LinkedList(const LinkedList& other) : head_(nullptr)
+template <class T, class Allocator>
+LinkedList<T, Allocator>::LinkedList(const LinkedList& other)
+  : NodeAllocator(std::allocator_traits<NodeAllocator>::select_on_container_copy_construction(other)),
+    head_(nullptr)
 {
   NodeType* current = other.head_;
   NodeType* last = nullptr;
@@ -77,12 +115,12 @@ LinkedList<T>::LinkedList(const LinkedList& other) : head_(nullptr)
   {
     if (last == nullptr)
     {
-      head_ = new NodeType(current->data);
+      head_ = createNode(nullptr, current->data);
       last = head_;
     }
     else
     {
-      last->next = new NodeType(current->data);
+      last->next = createNode(nullptr, current->data);
       last = last->next;
     }
     current = current->next;
@@ -90,64 +128,87 @@ LinkedList<T>::LinkedList(const LinkedList& other) : head_(nullptr)
   size_ = other.size_;
 }
 
-template <typename T>
-LinkedList<T>& LinkedList<T>::operator=(const LinkedList<T>& other)
+template <class T, class Allocator>
+LinkedList<T, Allocator>& LinkedList<T, Allocator>::operator=(const LinkedList<T, Allocator>& other)
 {
   if (this != &other)
   {
-    LinkedList<T> temp(other);
-    std::swap(head_, temp.head_);
-    std::swap(size_, temp.size_);
+    LinkedList<T, Allocator> temp(other);
+    swap(temp);
   }
   return *this;
 }
 
-template <class T>
-LinkedList<T>::LinkedList(LinkedList&& other) noexcept : head_(other.head_), size_(other.size_)
+template <class T, class Allocator>
+LinkedList<T, Allocator>::LinkedList(LinkedList&& other) noexcept
+  : NodeAllocator(std::move(static_cast<NodeAllocator&>(other))), head_(other.head_), size_(other.size_)
 {
   other.head_ = nullptr;
   other.size_ = 0;
 }
 
-template <class T>
-LinkedList<T>& LinkedList<T>::operator=(LinkedList&& other) noexcept
+template <class T, class Allocator>
+LinkedList<T, Allocator>& LinkedList<T, Allocator>::operator=(LinkedList&& other) noexcept
 {
   if (this != &other)
   {
-    std::swap(head_, other.head_);
-    std::swap(size_, other.size_);
+    swap(other);
   }
   return *this;
 }
 
-template <class T>
-bool LinkedList<T>::insert(const T& data)
+template <class T, class Allocator>
+bool LinkedList<T, Allocator>::insert(const T& data)
+{
+  head_ = createNode(head_, data);
+  ++size_;
+  return true;
+}
+
+template <class T, class Allocator>
+bool LinkedList<T, Allocator>::insert(T&& data)
 {
-  NodeType* newNode = new NodeType(data, head_);
-  head_ = newNode;
+  head_ = createNode(head_, std::move(data));
   ++size_;
   return true;
 }
 
-template <class T>
-bool LinkedList<T>::remove(const T& data)
+template <class T, class Allocator>
+template <class... Args>
+T& LinkedList<T, Allocator>::emplace(Args&&... args)
+{
+  head_ = createNode(head_, std::forward<Args>(args)...);
+  ++size_;
+  return head_->data;
+}
+
+template <class T, class Allocator>
+bool LinkedList<T, Allocator>::remove(const T& data)
+{
+  return removeFirstIf([&data](const T& value) { return value == data; });
+}
+
+// Removes the first element for which pred returns true.
+template <class T, class Allocator>
+template <class Predicate>
+bool LinkedList<T, Allocator>::removeFirstIf(Predicate pred)
 {
   NodeType* prevNode = nullptr;
   NodeType* curNode = head_;
   while (curNode != nullptr)
   {
-    if (curNode->data == data)
+    if (pred(curNode->data))
     {
       if (curNode == head_)
       {
         NodeType* tmp = head_->next;
-        delete head_;
+        destroyNode(head_);
         head_ = tmp;
       }
       else
       {
         prevNode->next = curNode->next;
-        delete curNode;
+        destroyNode(curNode);
       }
       --size_;
       return true;
@@ -158,90 +219,155 @@ bool LinkedList<T>::remove(const T& data)
   return false;
 }
 
-template <class T>
-void LinkedList<T>::clear()
+template <class T, class Allocator>
+void LinkedList<T, Allocator>::clear()
 {
   while (head_ != nullptr)
   {
     NodeType* tmp = head_->next;
-    delete head_;
+    destroyNode(head_);
     head_ = tmp;
   }
   size_ = 0;
 }
 
-template <class T>
-bool LinkedList<T>::empty() const
+template <class T, class Allocator>
+bool LinkedList<T, Allocator>::empty() const
 {
   return head_ == nullptr;
 }
 
-template <class T>
-T& LinkedList<T>::front()
+template <class T, class Allocator>
+T& LinkedList<T, Allocator>::front()
 {
   return head_->data;
 }
 
-template <class T>
-size_t LinkedList<T>::size() const
+template <class T, class Allocator>
+size_t LinkedList<T, Allocator>::size() const
 {
   return size_;
 }
 
-template <class T>
-typename LinkedList<T>::iterator LinkedList<T>::begin()
+template <class T, class Allocator>
+Allocator LinkedList<T, Allocator>::getAllocator() const
+{
+  return Allocator(static_cast<const NodeAllocator&>(*this));
+}
+
+template <class T, class Allocator>
+typename LinkedList<T, Allocator>::iterator LinkedList<T, Allocator>::begin()
 {
   return iterator(head_);
 }
 
-template <class T>
-typename LinkedList<T>::iterator LinkedList<T>::end()
+template <class T, class Allocator>
+typename LinkedList<T, Allocator>::iterator LinkedList<T, Allocator>::end()
 {
   return iterator(nullptr);
 }
 
-template <class T>
-typename LinkedList<T>::const_iterator LinkedList<T>::cbegin() const
+template <class T, class Allocator>
+typename LinkedList<T, Allocator>::const_iterator LinkedList<T, Allocator>::cbegin() const
 {
   return const_iterator(head_);
 }
 
-template <class T>
-typename LinkedList<T>::const_iterator LinkedList<T>::cend() const
+template <class T, class Allocator>
+typename LinkedList<T, Allocator>::const_iterator LinkedList<T, Allocator>::cend() const
 {
   return const_iterator(nullptr);
 }
 
+template <class T, class Allocator>
+template <class... Args>
+typename LinkedList<T, Allocator>::NodeType* LinkedList<T, Allocator>::createNode(NodeType* next, Args&&... args)
+{
+  NodeAllocator& allocator = *this;
+  NodeType* node = std::allocator_traits<NodeAllocator>::allocate(allocator, 1);
+  try
+  {
+    new (node) NodeType(std::in_place, next, std::forward<Args>(args)...);
+  }
+  catch (...)
+  {
+    std::allocator_traits<NodeAllocator>::deallocate(allocator, node, 1);
+    throw;
+  }
+  return node;
+}
+
+template <class T, class Allocator>
+void LinkedList<T, Allocator>::destroyNode(NodeType* node)
+{
+  NodeAllocator& allocator = *this;
+  node->~NodeType();
+  std::allocator_traits<NodeAllocator>::deallocate(allocator, node, 1);
+}
+
+template <class T, class Allocator>
+void LinkedList<T, Allocator>::swap(LinkedList& other) noexcept
+{
+  // Nodes must always be returned to the allocator that created them, so the
+  // allocator travels with the nodes.
+  std::swap(static_cast<NodeAllocator&>(*this), static_cast<NodeAllocator&>(other));
+  std::swap(head_, other.head_);
+  std::swap(size_, other.size_);
+}
 
-template <class T>
-SortedUniqueList<T>::SortedUniqueList() : BaseType() {}
 
-template <class T>
-SortedUniqueList<T>::SortedUniqueList(const SortedUniqueList<T>& other) : BaseType(other) {}
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>::SortedUniqueList() : BaseType() {}
 
-template <class T>
-SortedUniqueList<T>::SortedUniqueList(SortedUniqueList<T>&& other) noexcept : BaseType(std::move(other)) {}
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>::SortedUniqueList(const Allocator& allocator) : BaseType(allocator) {}
 
-template <class T>
-SortedUniqueList<T>& SortedUniqueList<T>::operator=(const SortedUniqueList<T>& other)
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>::SortedUniqueList(const SortedUniqueList<T, Allocator>& other) : BaseType(other) {}
+
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>::SortedUniqueList(SortedUniqueList<T, Allocator>&& other) noexcept : BaseType(std::move(other)) {}
+
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>& SortedUniqueList<T, Allocator>::operator=(const SortedUniqueList<T, Allocator>& other)
 {
   BaseType::operator=(other);
   return *this;
 }
 
-template <class T>
-SortedUniqueList<T>& SortedUniqueList<T>::operator=(SortedUniqueList<T>&& other) noexcept
+template <class T, class Allocator>
+SortedUniqueList<T, Allocator>& SortedUniqueList<T, Allocator>::operator=(SortedUniqueList<T, Allocator>&& other) noexcept
 {
   BaseType::operator=(std::move(other));
   return *this;
 }
 
-template <class T>
-bool SortedUniqueList<T>::insert(const T& data)
+template <class T, class Allocator>
+bool SortedUniqueList<T, Allocator>::insert(const T& data)
+{
+  return insertSorted(data);
+}
+
+template <class T, class Allocator>
+bool SortedUniqueList<T, Allocator>::insert(T&& data)
+{
+  return insertSorted(std::move(data));
+}
+
+template <class T, class Allocator>
+template <class... Args>
+bool SortedUniqueList<T, Allocator>::emplace(Args&&... args)
+{
+  return insertSorted(T(std::forward<Args>(args)...));
+}
+
+template <class T, class Allocator>
+template <class U>
+bool SortedUniqueList<T, Allocator>::insertSorted(U&& data)
 {
   if (this->head_ == nullptr || data < this->head_->data)
   {
-    this->head_ = new NodeType(data, this->head_);
+    this->head_ = this->createNode(this->head_, std::forward<U>(data));
     ++this->size_;
     return true;
   }
@@ -259,7 +385,7 @@ bool SortedUniqueList<T>::insert(const T& data)
 
   if (current->next == nullptr || current->next->data != data)
   {
-    current->next = new NodeType(data, current->next);
+    current->next = this->createNode(current->next, std::forward<U>(data));
     ++this->size_;
     return true;
   }
@@ -8,7 +8,7 @@
 #include "ListNode.h"
 
 
-template <class T>
+template <class T, class Allocator>
 class LinkedList;
 
 namespace detail
@@ -1,19 +1,34 @@
 #ifndef LIST_NODE_H
 #define LIST_NODE_H
 
+#include <utility>
+
 namespace detail
 {
   template <class T>
   struct ListNode
   {
     ListNode(const T& data, ListNode* next = nullptr);
-    
-    T data;
+    ListNode(T&& data, ListNode* next = nullptr);
+    template <class... Args>
+    ListNode(std::in_place_t, ListNode* next, Args&&... args);
+
+    // The link comes first so that walking a chain reads the same line as
+    // the start of the entry, whatever the size of T.
     ListNode* next;
+    T data;
   };
 
   template <class T>
-  ListNode<T>::ListNode(const T& data, ListNode* next) : data(data), next(next) {}
+  ListNode<T>::ListNode(const T& data, ListNode* next) : next(next), data(data) {}
+
+  template <class T>
+  ListNode<T>::ListNode(T&& data, ListNode* next) : next(next), data(std::move(data)) {}
+
+  template <class T>
+  template <class... Args>
+  ListNode<T>::ListNode(std::in_place_t, ListNode* next, Args&&... args)
+    : next(next), data(std::forward<Args>(args)...) {}
 }
 
 #endif
@@ -1,21 +1,78 @@
 #ifndef PAIR_H
 #define PAIR_H
 
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
 namespace detail
 {
   template <class T1, class T2>
   struct Pair
   {
+    template <class U1, class U2>
+    Pair(U1&& first, U2&& second);
+    template <class U1, class... Args>
+    Pair(std::in_place_t, U1&& first, Args&&... args);
+
     T1 first;
     T2 second;
   };
 
+  // Leading base of HashedPair: it puts the hash ahead of the key, so the
+  // check that comes before comparing keys reads the key's cache line rather
+  // than one past a large value.
+  struct StoredHash
+  {
+    std::size_t hash;
+  };
+
+  // Pair that also remembers the full hash of its key.
+  template <class T1, class T2>
+  struct HashedPair : StoredHash, Pair<T1, T2>
+  {
+    template <class... Args>
+    HashedPair(std::size_t hash, Args&&... args);
+  };
+
+  template <class T1, class T2>
+  void relocatePair(Pair<T1, T2>* to, Pair<T1, T2>& from);
+
   template <class T1, class T2>
   bool operator<(const Pair<T1, T2>& lhs, const Pair<T1, T2>& rhs);
 
   template <class T1, class T2>
   bool operator==(const Pair<T1, T2>& lhs, const Pair<T1, T2>& rhs);
 
+  template <class T1, class T2>
+  bool operator==(const HashedPair<T1, T2>& lhs, const HashedPair<T1, T2>& rhs);
+
+
+  template <class T1, class T2>
+  template <class U1, class U2>
+  Pair<T1, T2>::Pair(U1&& first, U2&& second)
+    : first(std::forward<U1>(first)), second(std::forward<U2>(second)) {}
+
+  template <class T1, class T2>
+  template <class U1, class... Args>
+  Pair<T1, T2>::Pair(std::in_place_t, U1&& first, Args&&... args)
+    : first(std::forward<U1>(first)), second(std::forward<Args>(args)...) {}
+
+  template <class T1, class T2>
+  template <class... Args>
+  HashedPair<T1, T2>::HashedPair(std::size_t hash, Args&&... args)
+    : StoredHash{ hash }, Pair<T1, T2>(std::forward<Args>(args)...) {}
+
+  // Moves from into the raw storage at to and destroys from. The key of a
+  // stored pair is const only so that users cannot change it in place; one
+  // that is about to be destroyed can give up its contents.
+  template <class T1, class T2>
+  void relocatePair(Pair<T1, T2>* to, Pair<T1, T2>& from)
+  {
+    new (to) Pair<T1, T2>(std::move(const_cast<std::remove_const_t<T1>&>(from.first)), std::move(from.second));
+    from.~Pair<T1, T2>();
+  }
 
   template <class T1, class T2>
   bool operator<(const Pair<T1, T2>& lhs, const Pair<T1, T2>& rhs)
@@ -28,6 +85,12 @@ namespace detail
   {
     return lhs.first == rhs.first;
   }
+
+  template <class T1, class T2>
+  bool operator==(const HashedPair<T1, T2>& lhs, const HashedPair<T1, T2>& rhs)
+  {
+    return lhs.hash == rhs.hash && lhs.first == rhs.first;
+  }
 }
 
 #endif
@@ -0,0 +1,80 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace detail
+{
+  static const std::size_t BULK_LOAD_MIN_CHUNK = 4096;
+
+  // Number of threads worth starting for count items: a power of two, at most
+  // the hardware concurrency, with at least BULK_LOAD_MIN_CHUNK items each.
+  // Allocators that are not always equal may keep unsynchronized state (such
+  // as PoolAllocator's free lists), so those loads stay on one thread.
+  template <class Allocator>
+  std::size_t bulkLoadThreads(std::size_t count)
+  {
+    if (!std::allocator_traits<Allocator>::is_always_equal::value)
+    {
+      return 1;
+    }
+
+    std::size_t limit = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    std::size_t threads = 1;
+    while (threads * 2 <= limit && threads * 2 * BULK_LOAD_MIN_CHUNK <= count)
+    {
+      threads <<= 1;
+    }
+    return threads;
+  }
+
+  // Runs task(0) ... task(count - 1) concurrently, task 0 on the calling
+  // thread, and rethrows the first exception once every task has finished.
+  template <class Task>
+  void parallelFor(std::size_t count, Task&& task)
+  {
+    std::vector<std::exception_ptr> errors(count);
+    std::vector<std::thread> threads;
+    threads.reserve(count > 0 ? count - 1 : 0);
+
+    auto run = [&task, &errors](std::size_t index)
+    {
+      try
+      {
+        task(index);
+      }
+      catch (...)
+      {
+        errors[index] = std::current_exception();
+      }
+    };
+
+    for (std::size_t i = 1; i < count; i++)
+    {
+      threads.emplace_back(run, i);
+    }
+    if (count > 0)
+    {
+      run(0);
+    }
+    for (std::thread& thread : threads)
+    {
+      thread.join();
+    }
+
+    for (const std::exception_ptr& error : errors)
+    {
+      if (error)
+      {
+        std::rethrow_exception(error);
+      }
+    }
+  }
+}
+
+#endif
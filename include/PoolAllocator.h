@@ -0,0 +1,215 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace detail
+{
+  static const std::size_t POOL_CHUNK_SIZE = 64 * 1024;
+  static const std::size_t POOL_SIZE_CLASS = 16;
+  static const std::size_t POOL_MAX_BLOCK_SIZE = 256;
+
+  // Slab allocator for small fixed-size blocks. Blocks are carved from large
+  // chunks and freed blocks are recycled through per-size free lists. Not
+  // thread-safe.
+  class NodePool
+  {
+  public:
+    NodePool();
+    ~NodePool();
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    void* allocate(std::size_t size);
+    void deallocate(void* block, std::size_t size);
+    void release();
+
+  private:
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    struct alignas(POOL_SIZE_CLASS) Chunk
+    {
+      Chunk* next;
+    };
+
+    FreeBlock* freeLists_[POOL_MAX_BLOCK_SIZE / POOL_SIZE_CLASS];
+    Chunk* chunks_;
+    char* cursor_;
+    char* chunkEnd_;
+    std::size_t liveBlocks_;
+
+    void freeChunks();
+    static std::size_t sizeClass(std::size_t size);
+  };
+
+
+  inline NodePool::NodePool()
+    : freeLists_(), chunks_(nullptr), cursor_(nullptr), chunkEnd_(nullptr), liveBlocks_(0)
+  {}
+
+  inline NodePool::~NodePool()
+  {
+    freeChunks();
+  }
+
+  inline void NodePool::freeChunks()
+  {
+    while (chunks_ != nullptr)
+    {
+      Chunk* next = chunks_->next;
+      ::operator delete(chunks_);
+      chunks_ = next;
+    }
+    for (FreeBlock*& freeList : freeLists_)
+    {
+      freeList = nullptr;
+    }
+    cursor_ = nullptr;
+    chunkEnd_ = nullptr;
+  }
+
+  inline std::size_t NodePool::sizeClass(std::size_t size)
+  {
+    return (size + POOL_SIZE_CLASS - 1) / POOL_SIZE_CLASS - 1;
+  }
+
+  inline void* NodePool::allocate(std::size_t size)
+  {
+    std::size_t index = sizeClass(size);
+    ++liveBlocks_;
+    if (freeLists_[index] != nullptr)
+    {
+      FreeBlock* block = freeLists_[index];
+      freeLists_[index] = block->next;
+      return block;
+    }
+
+    std::size_t blockSize = (index + 1) * POOL_SIZE_CLASS;
+    if (cursor_ == nullptr || static_cast<std::size_t>(chunkEnd_ - cursor_) < blockSize)
+    {
+      Chunk* chunk = static_cast<Chunk*>(::operator new(POOL_CHUNK_SIZE));
+      chunk->next = chunks_;
+      chunks_ = chunk;
+      cursor_ = reinterpret_cast<char*>(chunk + 1);
+      chunkEnd_ = reinterpret_cast<char*>(chunk) + POOL_CHUNK_SIZE;
+    }
+
+    void* block = cursor_;
+    cursor_ += blockSize;
+    return block;
+  }
+
+  inline void NodePool::deallocate(void* block, std::size_t size)
+  {
+    std::size_t index = sizeClass(size);
+    FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+    freeBlock->next = freeLists_[index];
+    freeLists_[index] = freeBlock;
+    --liveBlocks_;
+  }
+
+  // Hands every chunk back to the system in one go, provided no block is
+  // still in use.
+  inline void NodePool::release()
+  {
+    if (liveBlocks_ == 0)
+    {
+      freeChunks();
+    }
+  }
+}
+
+
+template <class T>
+class PoolAllocator
+{
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  PoolAllocator();
+  template <class U>
+  PoolAllocator(const PoolAllocator<U>& other);
+
+  T* allocate(std::size_t count);
+  void deallocate(T* ptr, std::size_t count);
+  void release();
+
+  template <class U>
+  bool operator==(const PoolAllocator<U>& other) const;
+  template <class U>
+  bool operator!=(const PoolAllocator<U>& other) const;
+
+private:
+  template <class U>
+  friend class PoolAllocator;
+
+  std::shared_ptr<detail::NodePool> pool_;
+
+  static bool isPooled(std::size_t count);
+};
+
+
+template <class T>
+PoolAllocator<T>::PoolAllocator() : pool_(std::make_shared<detail::NodePool>()) {}
+
+template <class T>
+template <class U>
+PoolAllocator<T>::PoolAllocator(const PoolAllocator<U>& other) : pool_(other.pool_) {}
+
+template <class T>
+bool PoolAllocator<T>::isPooled(std::size_t count)
+{
+  return count == 1 && sizeof(T) <= detail::POOL_MAX_BLOCK_SIZE && alignof(T) <= detail::POOL_SIZE_CLASS;
+}
+
+template <class T>
+T* PoolAllocator<T>::allocate(std::size_t count)
+{
+  if (!isPooled(count))
+  {
+    return static_cast<T*>(::operator new(count * sizeof(T)));
+  }
+  return static_cast<T*>(pool_->allocate(sizeof(T)));
+}
+
+template <class T>
+void PoolAllocator<T>::deallocate(T* ptr, std::size_t count)
+{
+  if (!isPooled(count))
+  {
+    ::operator delete(ptr);
+    return;
+  }
+  pool_->deallocate(ptr, sizeof(T));
+}
+
+template <class T>
+void PoolAllocator<T>::release()
+{
+  pool_->release();
+}
+
+template <class T>
+template <class U>
+bool PoolAllocator<T>::operator==(const PoolAllocator<U>& other) const
+{
+  return pool_ == other.pool_;
+}
+
+template <class T>
+template <class U>
+bool PoolAllocator<T>::operator!=(const PoolAllocator<U>& other) const
+{
+  return pool_ != other.pool_;
+}
+
+#endif
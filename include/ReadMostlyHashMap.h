@@ -0,0 +1,336 @@
+#ifndef READ_MOSTLY_HASH_MAP_H
+#define READ_MOSTLY_HASH_MAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+#include "EpochReclaimer.h"
+#include "HashMap.h"
+#include "ReadMostlyHashMapIterator.h"
+
+// Chained map for workloads dominated by lookups. find(), visit() and the
+// const iterators take no locks: they pin an epoch and follow atomically
+// published pointers. Writers are serialized by a mutex and never modify a
+// published node in place; replaced and removed nodes, and whole bucket
+// arrays dropped by rehash(), are handed to the epoch domain and freed only
+// once no reader can still hold them.
+//
+// rehash() publishes a fresh table of copied nodes rather than relinking the
+// old ones, because a reader still walking an old chain must not be diverted
+// into another bucket. Keys and values must therefore be copyable.
+template <class Key, class T, class Hash = std::hash<Key>>
+class ReadMostlyHashMap
+{
+public:
+  using const_iterator = detail::ReadMostlyIterator<Key, T>;
+
+  using PairType = detail::Pair<const Key, T>;
+  using NodeType = detail::ReadMostlyNode<Key, T>;
+  using TableType = detail::ReadMostlyTable<Key, T>;
+
+  explicit ReadMostlyHashMap(std::size_t bucketCount = 8);
+  ~ReadMostlyHashMap();
+  ReadMostlyHashMap(const ReadMostlyHashMap&) = delete;
+  ReadMostlyHashMap& operator=(const ReadMostlyHashMap&) = delete;
+
+  void insert(const Key& key, const T& value = T());
+  template <class... Args>
+  bool tryEmplace(const Key& key, Args&&... args);
+  template <class M>
+  bool insertOrAssign(const Key& key, M&& value);
+  bool find(const Key& key, T& value) const;
+  bool contains(const Key& key) const;
+  template <class F>
+  bool visit(const Key& key, F&& f) const;
+  bool remove(const Key& key);
+  void clear();
+  void rehash(std::size_t count = 0);
+  std::size_t size() const;
+  bool empty() const;
+  float loadFactor() const;
+  void setMaxLoadFactor(float maxLoadFactor);
+
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+private:
+  std::atomic<TableType*> table_;
+  std::atomic<std::size_t> size_;
+  float maxLoadFactor_;
+  std::mutex writeMutex_;
+
+  const NodeType* findNode(const TableType* table, const Key& key, std::size_t hash) const;
+  std::atomic<NodeType*>* findLink(TableType* table, const Key& key, std::size_t hash);
+  template <class... Args>
+  void insertNew(std::size_t hash, const Key& key, Args&&... args);
+  void rehashLocked(std::size_t minSize);
+
+  static void destroyNode(void* node);
+  static void destroyTable(void* table);
+};
+
+
+template <class Key, class T, class Hash>
+ReadMostlyHashMap<Key, T, Hash>::ReadMostlyHashMap(std::size_t initialBucketCount)
+  : table_(nullptr), size_(0), maxLoadFactor_(detail::DEFAULT_MAX_LOAD_FACTOR)
+{
+  std::size_t bucketCount = 8;
+  while (bucketCount < initialBucketCount)
+  {
+    bucketCount <<= 1;
+  }
+  table_.store(new TableType(bucketCount));
+}
+
+template <class Key, class T, class Hash>
+ReadMostlyHashMap<Key, T, Hash>::~ReadMostlyHashMap()
+{
+  destroyTable(table_.load());
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::insert(const Key& key, const T& value)
+{
+  insertOrAssign(key, value);
+}
+
+template <class Key, class T, class Hash>
+template <class... Args>
+bool ReadMostlyHashMap<Key, T, Hash>::tryEmplace(const Key& key, Args&&... args)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  std::size_t hash = Hash{}(key);
+  if (findLink(table_.load(std::memory_order_relaxed), key, hash) != nullptr)
+  {
+    return false;
+  }
+  insertNew(hash, key, std::forward<Args>(args)...);
+  return true;
+}
+
+template <class Key, class T, class Hash>
+template <class M>
+bool ReadMostlyHashMap<Key, T, Hash>::insertOrAssign(const Key& key, M&& value)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  std::size_t hash = Hash{}(key);
+  std::atomic<NodeType*>* link = findLink(table_.load(std::memory_order_relaxed), key, hash);
+  if (link == nullptr)
+  {
+    insertNew(hash, key, std::forward<M>(value));
+    return true;
+  }
+
+  NodeType* oldNode = link->load(std::memory_order_relaxed);
+  NodeType* node = new NodeType(hash, oldNode->next.load(std::memory_order_relaxed),
+    std::in_place, oldNode->data.first, std::forward<M>(value));
+  link->store(node, std::memory_order_release);
+  detail::EpochDomain::instance().retire(oldNode, &destroyNode);
+  return false;
+}
+
+template <class Key, class T, class Hash>
+bool ReadMostlyHashMap<Key, T, Hash>::find(const Key& key, T& value) const
+{
+  return visit(key, [&value](const T& found) { value = found; });
+}
+
+template <class Key, class T, class Hash>
+bool ReadMostlyHashMap<Key, T, Hash>::contains(const Key& key) const
+{
+  return visit(key, [](const T&) {});
+}
+
+// Calls f(const T&) on the entry while the thread is pinned; the reference
+// must not be kept after f returns.
+template <class Key, class T, class Hash>
+template <class F>
+bool ReadMostlyHashMap<Key, T, Hash>::visit(const Key& key, F&& f) const
+{
+  detail::EpochGuard guard;
+  const NodeType* node = findNode(table_.load(std::memory_order_acquire), key, Hash{}(key));
+  if (node == nullptr)
+  {
+    return false;
+  }
+  f(node->data.second);
+  return true;
+}
+
+template <class Key, class T, class Hash>
+bool ReadMostlyHashMap<Key, T, Hash>::remove(const Key& key)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  std::atomic<NodeType*>* link = findLink(table_.load(std::memory_order_relaxed), key, Hash{}(key));
+  if (link == nullptr)
+  {
+    return false;
+  }
+
+  // The removed node keeps its next pointer, so a reader standing on it can
+  // still finish walking the chain.
+  NodeType* node = link->load(std::memory_order_relaxed);
+  link->store(node->next.load(std::memory_order_relaxed), std::memory_order_release);
+  size_.fetch_sub(1, std::memory_order_relaxed);
+  detail::EpochDomain::instance().retire(node, &destroyNode);
+  return true;
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::clear()
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  TableType* oldTable = table_.load(std::memory_order_relaxed);
+  table_.store(new TableType(oldTable->bucketCount), std::memory_order_release);
+  size_.store(0, std::memory_order_relaxed);
+  detail::EpochDomain::instance().retire(oldTable, &destroyTable);
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::rehash(std::size_t count)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  rehashLocked(count);
+}
+
+template <class Key, class T, class Hash>
+std::size_t ReadMostlyHashMap<Key, T, Hash>::size() const
+{
+  return size_.load(std::memory_order_relaxed);
+}
+
+template <class Key, class T, class Hash>
+bool ReadMostlyHashMap<Key, T, Hash>::empty() const
+{
+  return size() == 0;
+}
+
+template <class Key, class T, class Hash>
+float ReadMostlyHashMap<Key, T, Hash>::loadFactor() const
+{
+  detail::EpochGuard guard;
+  return static_cast<float>(size()) / static_cast<float>(table_.load(std::memory_order_acquire)->bucketCount);
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::setMaxLoadFactor(float maxLoadFactor)
+{
+  if (maxLoadFactor < 0.05f || maxLoadFactor > 1.0f)
+  {
+    throw std::invalid_argument("Load factor must be greater than 0.05 and less than 1.");
+  }
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  maxLoadFactor_ = maxLoadFactor;
+}
+
+template <class Key, class T, class Hash>
+typename ReadMostlyHashMap<Key, T, Hash>::const_iterator ReadMostlyHashMap<Key, T, Hash>::cbegin() const
+{
+  return const_iterator(table_);
+}
+
+template <class Key, class T, class Hash>
+typename ReadMostlyHashMap<Key, T, Hash>::const_iterator ReadMostlyHashMap<Key, T, Hash>::cend() const
+{
+  return const_iterator();
+}
+
+template <class Key, class T, class Hash>
+const typename ReadMostlyHashMap<Key, T, Hash>::NodeType* ReadMostlyHashMap<Key, T, Hash>::findNode(const TableType* table, const Key& key, std::size_t hash) const
+{
+  const NodeType* node = table->buckets[hash & (table->bucketCount - 1)].load(std::memory_order_acquire);
+  while (node != nullptr && (node->hash != hash || !(node->data.first == key)))
+  {
+    node = node->next.load(std::memory_order_acquire);
+  }
+  return node;
+}
+
+// Writer-side lookup: returns the link that points at the key's node, or
+// nullptr. Only called with writeMutex_ held.
+template <class Key, class T, class Hash>
+std::atomic<typename ReadMostlyHashMap<Key, T, Hash>::NodeType*>* ReadMostlyHashMap<Key, T, Hash>::findLink(TableType* table, const Key& key, std::size_t hash)
+{
+  std::atomic<NodeType*>* link = &table->buckets[hash & (table->bucketCount - 1)];
+  for (NodeType* node = link->load(std::memory_order_relaxed); node != nullptr; node = link->load(std::memory_order_relaxed))
+  {
+    if (node->hash == hash && node->data.first == key)
+    {
+      return link;
+    }
+    link = &node->next;
+  }
+  return nullptr;
+}
+
+template <class Key, class T, class Hash>
+template <class... Args>
+void ReadMostlyHashMap<Key, T, Hash>::insertNew(std::size_t hash, const Key& key, Args&&... args)
+{
+  TableType* table = table_.load(std::memory_order_relaxed);
+  if (static_cast<float>(size() + 1) / static_cast<float>(table->bucketCount) > maxLoadFactor_)
+  {
+    rehashLocked(0);
+    table = table_.load(std::memory_order_relaxed);
+  }
+
+  std::atomic<NodeType*>& bucket = table->buckets[hash & (table->bucketCount - 1)];
+  NodeType* node = new NodeType(hash, bucket.load(std::memory_order_relaxed), std::in_place, key, std::forward<Args>(args)...);
+  bucket.store(node, std::memory_order_release);
+  size_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::rehashLocked(std::size_t minSize)
+{
+  TableType* oldTable = table_.load(std::memory_order_relaxed);
+  std::size_t bucketCount = oldTable->bucketCount;
+  while (bucketCount < minSize || bucketCount < (size() + 1) / maxLoadFactor_)
+  {
+    bucketCount <<= 1;
+  }
+
+  TableType* table = new TableType(bucketCount);
+  for (std::size_t i = 0; i < oldTable->bucketCount; i++)
+  {
+    for (NodeType* node = oldTable->buckets[i].load(std::memory_order_relaxed); node != nullptr;
+      node = node->next.load(std::memory_order_relaxed))
+    {
+      std::atomic<NodeType*>& bucket = table->buckets[node->hash & (bucketCount - 1)];
+      bucket.store(new NodeType(node->hash, bucket.load(std::memory_order_relaxed), node->data.first, node->data.second),
+        std::memory_order_relaxed);
+    }
+  }
+
+  table_.store(table, std::memory_order_release);
+  detail::EpochDomain::instance().retire(oldTable, &destroyTable);
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::destroyNode(void* node)
+{
+  delete static_cast<NodeType*>(node);
+}
+
+template <class Key, class T, class Hash>
+void ReadMostlyHashMap<Key, T, Hash>::destroyTable(void* table)
+{
+  TableType* oldTable = static_cast<TableType*>(table);
+  for (std::size_t i = 0; i < oldTable->bucketCount; i++)
+  {
+    NodeType* node = oldTable->buckets[i].load(std::memory_order_relaxed);
+    while (node != nullptr)
+    {
+      NodeType* next = node->next.load(std::memory_order_relaxed);
+      delete node;
+      node = next;
+    }
+  }
+  delete oldTable;
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef READ_MOSTLY_HASH_MAP_ITERATOR_H
+#define READ_MOSTLY_HASH_MAP_ITERATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "EpochReclaimer.h"
+#include "Pair.h"
+
+namespace detail
+{
+  // Nodes are immutable once published: assigning a value replaces the node,
+  // so a reader never observes a half-written entry.
+  template <class Key, class T>
+  struct ReadMostlyNode
+  {
+    template <class... Args>
+    ReadMostlyNode(std::size_t hash, ReadMostlyNode* next, Args&&... args);
+
+    Pair<const Key, T> data;
+    std::size_t hash;
+    std::atomic<ReadMostlyNode*> next;
+  };
+
+  template <class Key, class T>
+  struct ReadMostlyTable
+  {
+    using NodeType = ReadMostlyNode<Key, T>;
+
+    explicit ReadMostlyTable(std::size_t bucketCount);
+
+    std::size_t bucketCount;
+    std::unique_ptr<std::atomic<NodeType*>[]> buckets;
+  };
+
+  // Walks one published table. The iterator keeps its thread pinned, so the
+  // table and its nodes stay alive however the map changes meanwhile; entries
+  // written after the walk started may or may not be seen.
+  template <class Key, class T>
+  class ReadMostlyIterator
+  {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = Pair<const Key, T>;
+    using reference = const value_type&;
+    using pointer = const value_type*;
+
+    using TableType = ReadMostlyTable<Key, T>;
+    using NodeType = ReadMostlyNode<Key, T>;
+
+    ReadMostlyIterator();
+    explicit ReadMostlyIterator(const std::atomic<TableType*>& table);
+
+    reference operator*() const;
+    pointer operator->() const;
+    ReadMostlyIterator& operator++();
+    ReadMostlyIterator operator++(int);
+    bool operator==(const ReadMostlyIterator& other) const;
+    bool operator!=(const ReadMostlyIterator& other) const;
+
+  private:
+    EpochGuard guard_;
+    const TableType* table_;
+    std::size_t bucket_;
+    const NodeType* node_;
+
+    void skipEmptyBuckets();
+  };
+
+
+  template <class Key, class T>
+  template <class... Args>
+  ReadMostlyNode<Key, T>::ReadMostlyNode(std::size_t hash, ReadMostlyNode* next, Args&&... args)
+    : data(std::forward<Args>(args)...), hash(hash), next(next) {}
+
+  template <class Key, class T>
+  ReadMostlyTable<Key, T>::ReadMostlyTable(std::size_t bucketCount)
+    : bucketCount(bucketCount), buckets(new std::atomic<NodeType*>[bucketCount])
+  {
+    for (std::size_t i = 0; i < bucketCount; i++)
+    {
+      buckets[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  template <class Key, class T>
+  ReadMostlyIterator<Key, T>::ReadMostlyIterator() : guard_(false), table_(nullptr), bucket_(0), node_(nullptr) {}
+
+  template <class Key, class T>
+  ReadMostlyIterator<Key, T>::ReadMostlyIterator(const std::atomic<TableType*>& table)
+    : guard_(true), table_(table.load(std::memory_order_acquire)), bucket_(0),
+      node_(table_->buckets[0].load(std::memory_order_acquire))
+  {
+    skipEmptyBuckets();
+  }
+
+  template <class Key, class T>
+  typename ReadMostlyIterator<Key, T>::reference ReadMostlyIterator<Key, T>::operator*() const
+  {
+    return node_->data;
+  }
+
+  template <class Key, class T>
+  typename ReadMostlyIterator<Key, T>::pointer ReadMostlyIterator<Key, T>::operator->() const
+  {
+    return &node_->data;
+  }
+
+  template <class Key, class T>
+  ReadMostlyIterator<Key, T>& ReadMostlyIterator<Key, T>::operator++()
+  {
+    node_ = node_->next.load(std::memory_order_acquire);
+    skipEmptyBuckets();
+    return *this;
+  }
+
+  template <class Key, class T>
+  ReadMostlyIterator<Key, T> ReadMostlyIterator<Key, T>::operator++(int)
+  {
+    ReadMostlyIterator<Key, T> temp = *this;
+    operator++();
+    return temp;
+  }
+
+  template <class Key, class T>
+  bool ReadMostlyIterator<Key, T>::operator==(const ReadMostlyIterator<Key, T>& other) const
+  {
+    return node_ == other.node_;
+  }
+
+  template <class Key, class T>
+  bool ReadMostlyIterator<Key, T>::operator!=(const ReadMostlyIterator<Key, T>& other) const
+  {
+    return !(*this == other);
+  }
+
+  template <class Key, class T>
+  void ReadMostlyIterator<Key, T>::skipEmptyBuckets()
+  {
+    while (node_ == nullptr && ++bucket_ < table_->bucketCount)
+    {
+      node_ = table_->buckets[bucket_].load(std::memory_order_acquire);
+    }
+  }
+}
+
+#endif
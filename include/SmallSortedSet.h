@@ -0,0 +1,368 @@
+#ifndef SMALL_SORTED_SET_H
+#define SMALL_SORTED_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Set of unique values kept sorted in one contiguous array. The first
+// InlineCount values live inside the object itself; only a larger set
+// allocates, and then it stores all of its values in a single heap block.
+// Lookup, insert and remove are a binary search plus a shift of the tail.
+template <class T, std::size_t InlineCount = 4, class Allocator = std::allocator<T>>
+class SmallSortedSet : private Allocator
+{
+  static_assert(InlineCount > 0, "SmallSortedSet needs room for at least one inline value.");
+
+public:
+  // Values are only ever read through iterators, since changing one in place
+  // could break the ordering.
+  using iterator = const T*;
+  using const_iterator = const T*;
+
+  using value_type = T;
+  using allocator_type = Allocator;
+
+  SmallSortedSet();
+  explicit SmallSortedSet(const Allocator& allocator);
+  ~SmallSortedSet();
+  SmallSortedSet(const SmallSortedSet& other);
+  SmallSortedSet& operator=(const SmallSortedSet& other);
+  SmallSortedSet(SmallSortedSet&& other) noexcept;
+  SmallSortedSet& operator=(SmallSortedSet&& other) noexcept;
+
+  bool insert(const T& value);
+  bool insert(T&& value);
+  template <class... Args>
+  bool emplace(Args&&... args);
+  template <class K>
+  bool remove(const K& value);
+  template <class K>
+  const_iterator find(const K& value) const;
+  template <class K>
+  bool contains(const K& value) const;
+  void clear();
+  bool empty() const;
+  const T& front() const;
+  const T& operator[](std::size_t index) const;
+  std::size_t size() const;
+  std::size_t capacity() const;
+  bool isInline() const;
+  Allocator getAllocator() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+private:
+  T* data_;
+  std::size_t size_;
+  std::size_t capacity_;
+  alignas(T) unsigned char inline_[InlineCount * sizeof(T)];
+
+  T* inlineData();
+  template <class U>
+  bool insertSorted(U&& value);
+  template <class K>
+  T* lowerBound(const K& value) const;
+  void grow();
+  void destroyAll();
+  void takeFrom(SmallSortedSet& other);
+};
+
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>::SmallSortedSet()
+  : data_(inlineData()), size_(0), capacity_(InlineCount)
+{}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>::SmallSortedSet(const Allocator& allocator)
+  : Allocator(allocator), data_(inlineData()), size_(0), capacity_(InlineCount)
+{}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>::~SmallSortedSet()
+{
+  destroyAll();
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>::SmallSortedSet(const SmallSortedSet& other)
+  : Allocator(std::allocator_traits<Allocator>::select_on_container_copy_construction(other)),
+    data_(inlineData()), size_(0), capacity_(InlineCount)
+{
+  if (other.size_ > InlineCount)
+  {
+    data_ = std::allocator_traits<Allocator>::allocate(*this, other.size_);
+    capacity_ = other.size_;
+  }
+  for (; size_ < other.size_; ++size_)
+  {
+    new (data_ + size_) T(other.data_[size_]);
+  }
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>& SmallSortedSet<T, InlineCount, Allocator>::operator=(const SmallSortedSet& other)
+{
+  if (this != &other)
+  {
+    SmallSortedSet temp(other);
+    *this = std::move(temp);
+  }
+  return *this;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>::SmallSortedSet(SmallSortedSet&& other) noexcept
+  : Allocator(std::move(static_cast<Allocator&>(other))), data_(inlineData()), size_(0), capacity_(InlineCount)
+{
+  takeFrom(other);
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+SmallSortedSet<T, InlineCount, Allocator>& SmallSortedSet<T, InlineCount, Allocator>::operator=(SmallSortedSet&& other) noexcept
+{
+  if (this != &other)
+  {
+    destroyAll();
+    // As with LinkedList, a heap block must go back to the allocator that
+    // created it, so the allocator travels with the values.
+    static_cast<Allocator&>(*this) = std::move(static_cast<Allocator&>(other));
+    takeFrom(other);
+  }
+  return *this;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+bool SmallSortedSet<T, InlineCount, Allocator>::insert(const T& value)
+{
+  return insertSorted(value);
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+bool SmallSortedSet<T, InlineCount, Allocator>::insert(T&& value)
+{
+  return insertSorted(std::move(value));
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+template <class... Args>
+bool SmallSortedSet<T, InlineCount, Allocator>::emplace(Args&&... args)
+{
+  return insertSorted(T(std::forward<Args>(args)...));
+}
+
+// Removes the value equal to value; K may be any type T compares with using
+// < and ==, such as std::string_view for std::string.
+template <class T, std::size_t InlineCount, class Allocator>
+template <class K>
+bool SmallSortedSet<T, InlineCount, Allocator>::remove(const K& value)
+{
+  T* position = lowerBound(value);
+  if (position == data_ + size_ || !(*position == value))
+  {
+    return false;
+  }
+
+  std::move(position + 1, data_ + size_, position);
+  data_[--size_].~T();
+  return true;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+template <class K>
+typename SmallSortedSet<T, InlineCount, Allocator>::const_iterator SmallSortedSet<T, InlineCount, Allocator>::find(const K& value) const
+{
+  const T* position = lowerBound(value);
+  return position != end() && *position == value ? position : end();
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+template <class K>
+bool SmallSortedSet<T, InlineCount, Allocator>::contains(const K& value) const
+{
+  return find(value) != end();
+}
+
+// Also hands a heap block back, so a cleared set owns no memory.
+template <class T, std::size_t InlineCount, class Allocator>
+void SmallSortedSet<T, InlineCount, Allocator>::clear()
+{
+  destroyAll();
+  data_ = inlineData();
+  size_ = 0;
+  capacity_ = InlineCount;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+bool SmallSortedSet<T, InlineCount, Allocator>::empty() const
+{
+  return size_ == 0;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+const T& SmallSortedSet<T, InlineCount, Allocator>::front() const
+{
+  return data_[0];
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+const T& SmallSortedSet<T, InlineCount, Allocator>::operator[](std::size_t index) const
+{
+  return data_[index];
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+std::size_t SmallSortedSet<T, InlineCount, Allocator>::size() const
+{
+  return size_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+std::size_t SmallSortedSet<T, InlineCount, Allocator>::capacity() const
+{
+  return capacity_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+bool SmallSortedSet<T, InlineCount, Allocator>::isInline() const
+{
+  return data_ == reinterpret_cast<const T*>(inline_);
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+Allocator SmallSortedSet<T, InlineCount, Allocator>::getAllocator() const
+{
+  return static_cast<const Allocator&>(*this);
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+typename SmallSortedSet<T, InlineCount, Allocator>::const_iterator SmallSortedSet<T, InlineCount, Allocator>::begin() const
+{
+  return data_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+typename SmallSortedSet<T, InlineCount, Allocator>::const_iterator SmallSortedSet<T, InlineCount, Allocator>::end() const
+{
+  return data_ + size_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+typename SmallSortedSet<T, InlineCount, Allocator>::const_iterator SmallSortedSet<T, InlineCount, Allocator>::cbegin() const
+{
+  return data_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+typename SmallSortedSet<T, InlineCount, Allocator>::const_iterator SmallSortedSet<T, InlineCount, Allocator>::cend() const
+{
+  return data_ + size_;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+T* SmallSortedSet<T, InlineCount, Allocator>::inlineData()
+{
+  return reinterpret_cast<T*>(inline_);
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+template <class U>
+bool SmallSortedSet<T, InlineCount, Allocator>::insertSorted(U&& value)
+{
+  std::size_t index = static_cast<std::size_t>(lowerBound(value) - data_);
+  if (index < size_ && data_[index] == value)
+  {
+    return false;
+  }
+
+  if (size_ == capacity_)
+  {
+    grow();
+  }
+  if (index == size_)
+  {
+    new (data_ + size_) T(std::forward<U>(value));
+  }
+  else
+  {
+    new (data_ + size_) T(std::move(data_[size_ - 1]));
+    std::move_backward(data_ + index, data_ + size_ - 1, data_ + size_);
+    data_[index] = std::forward<U>(value);
+  }
+  ++size_;
+  return true;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+template <class K>
+T* SmallSortedSet<T, InlineCount, Allocator>::lowerBound(const K& value) const
+{
+  return std::lower_bound(data_, data_ + size_, value,
+    [](const T& element, const K& key) { return element < key; });
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+void SmallSortedSet<T, InlineCount, Allocator>::grow()
+{
+  std::size_t capacity = capacity_ > 0 ? capacity_ * 2 : 2;
+  T* data = std::allocator_traits<Allocator>::allocate(*this, capacity);
+  for (std::size_t i = 0; i < size_; i++)
+  {
+    new (data + i) T(std::move(data_[i]));
+    data_[i].~T();
+  }
+  if (!isInline())
+  {
+    std::allocator_traits<Allocator>::deallocate(*this, data_, capacity_);
+  }
+  data_ = data;
+  capacity_ = capacity;
+}
+
+template <class T, std::size_t InlineCount, class Allocator>
+void SmallSortedSet<T, InlineCount, Allocator>::destroyAll()
+{
+  for (std::size_t i = 0; i < size_; i++)
+  {
+    data_[i].~T();
+  }
+  if (!isInline())
+  {
+    std::allocator_traits<Allocator>::deallocate(*this, data_, capacity_);
+  }
+}
+
+// Adopts other's values, stealing a heap block or moving inline values one by
+// one, and leaves other empty. Expects this set to own nothing.
+template <class T, std::size_t InlineCount, class Allocator>
+void SmallSortedSet<T, InlineCount, Allocator>::takeFrom(SmallSortedSet& other)
+{
+  if (other.isInline())
+  {
+    data_ = inlineData();
+    capacity_ = InlineCount;
+    for (std::size_t i = 0; i < other.size_; i++)
+    {
+      new (data_ + i) T(std::move(other.data_[i]));
+      other.data_[i].~T();
+    }
+  }
+  else
+  {
+    data_ = other.data_;
+    capacity_ = other.capacity_;
+  }
+  size_ = other.size_;
+
+  other.data_ = other.inlineData();
+  other.size_ = 0;
+  other.capacity_ = InlineCount;
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef STATIC_DICTIONARY_H
+#define STATIC_DICTIONARY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Dictionary.h"
+#include "Hash.h"
+
+namespace detail
+{
+  // Average number of words sharing one pilot. Larger buckets make the pilot
+  // table smaller and the search for pilots longer.
+  static const std::size_t STATIC_BUCKET_SIZE = 4;
+
+  // hash * range / 2^64: maps a hash onto [0, range) with one multiply.
+  inline std::uint64_t fastRange(std::uint64_t hash, std::uint64_t range)
+  {
+    multiply128(hash, range);
+    return range;
+  }
+
+  // Slot of a word whose bucket has the given pilot. Words of one bucket have
+  // close hashes in the bits fastRange() looks at, so the hash is remixed with
+  // the pilot rather than just offset by it.
+  inline std::size_t staticSlot(std::uint64_t hash, std::uint32_t pilot, std::size_t slotCount)
+  {
+    return static_cast<std::size_t>(fastRange(multiplyMix(hash ^ HASH_SECRET[2], pilot ^ HASH_SECRET[3]), slotCount));
+  }
+}
+
+
+// Translations of one word in a static table.
+class StaticTranslations
+{
+public:
+  using const_iterator = const std::string_view*;
+
+  constexpr StaticTranslations() : strings_(nullptr), count_(0) {}
+  constexpr StaticTranslations(const std::string_view* strings, std::size_t count) : strings_(strings), count_(count) {}
+
+  constexpr bool empty() const { return count_ == 0; }
+  constexpr std::size_t size() const { return count_; }
+  constexpr std::string_view operator[](std::size_t index) const { return strings_[index]; }
+  constexpr const_iterator begin() const { return strings_; }
+  constexpr const_iterator end() const { return strings_ + count_; }
+
+private:
+  const std::string_view* strings_;
+  std::size_t count_;
+};
+
+namespace detail
+{
+  // The hash lets a lookup turn away a missing word without reading the
+  // bytes of the word in its slot.
+  struct StaticEntry
+  {
+    std::string_view first;
+    StaticTranslations second;
+    std::uint64_t hash;
+  };
+}
+
+
+// Read-only dictionary over tables fixed at build time. The words are placed
+// by a minimal perfect hash (PTHash): a word's hash picks a bucket, the
+// bucket's pilot picks the word's slot, and every slot holds exactly one
+// word. A lookup is one hash, one pilot load and one compare against the only
+// word that can match, with no probing and no allocation.
+//
+// The tables are normally generated by static_dictionary_gen from a
+// "word - translation" list (see hashmap_add_static_dictionary() in
+// CMakeLists.txt) and are then constant-initialized data. StaticDictionaryBuilder
+// makes the same tables at run time.
+class StaticDictionary
+{
+public:
+  using const_iterator = const detail::StaticEntry*;
+  using iterator = const_iterator;
+
+  constexpr StaticDictionary()
+    : entries_(nullptr), size_(0), pilots_(nullptr), bucketCount_(0), seed_(0) {}
+  constexpr StaticDictionary(const detail::StaticEntry* entries, std::size_t size, const std::uint32_t* pilots,
+    std::size_t bucketCount, std::uint64_t seed)
+    : entries_(entries), size_(size), pilots_(pilots), bucketCount_(bucketCount), seed_(seed) {}
+
+  const_iterator find(std::string_view word) const;
+  bool contains(std::string_view word) const;
+  std::size_t size() const;
+  bool empty() const;
+
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
+private:
+  const detail::StaticEntry* entries_;
+  std::size_t size_;
+  const std::uint32_t* pilots_;
+  std::size_t bucketCount_;
+  std::uint64_t seed_;
+};
+
+
+// Collects (word, translation) pairs and lays them out as a StaticDictionary.
+// build() searches for the perfect hash; the dictionary it returns points into
+// the builder and is valid until the builder is modified or destroyed.
+// writeSource() prints the same tables as C++ that needs no builder at all.
+class StaticDictionaryBuilder
+{
+public:
+  void insert(const std::string& word, const std::string& translation);
+  std::size_t size() const;
+  StaticDictionary build();
+  void writeHeader(std::ostream& out, const std::string& name) const;
+  void writeSource(std::ostream& out, const std::string& name) const;
+
+private:
+  Dictionary words_;
+
+  // Tables of the last build(), in slot order; the views point into arena_.
+  std::string arena_;
+  std::vector<std::string_view> translations_;
+  std::vector<detail::StaticEntry> entries_;
+  std::vector<std::uint32_t> pilots_;
+  std::uint64_t seed_ = 0;
+
+  bool findPilots(const std::vector<std::uint64_t>& hashes, std::vector<std::size_t>& slots);
+};
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+using StringId = std::uint32_t;
+
+namespace detail
+{
+  static const std::size_t STRING_POOL_BLOCK_SIZE = 64 * 1024;
+  static const StringId NO_STRING_ID = UINT32_MAX;
+}
+
+// Append-only store of unique strings. Each distinct string is kept once,
+// prefixed by its length, in large arena blocks and named by a dense 32-bit
+// id, so equal strings compare as equal ids. Strings never move: the views
+// returned by view() stay valid until clear(). Not thread-safe.
+class StringPool
+{
+public:
+  StringPool();
+  StringPool(const StringPool&) = delete;
+  StringPool& operator=(const StringPool&) = delete;
+  StringPool(StringPool&& other) noexcept;
+  StringPool& operator=(StringPool&& other) noexcept;
+
+  StringId intern(std::string_view value);
+  bool find(std::string_view value, StringId& id) const;
+  std::string_view view(StringId id) const;
+  void clear();
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t memoryUsage() const;
+
+private:
+  // Open-addressed dedup index over the ids; tag holds the high hash bits so
+  // most mismatches are rejected without touching the arena.
+  struct Slot
+  {
+    StringId id;
+    std::uint32_t tag;
+  };
+
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  std::size_t arenaBytes_;
+  char* cursor_;
+  std::size_t remaining_;
+  std::vector<const char*> strings_;
+  std::vector<Slot> slots_;
+
+  std::size_t findSlot(std::string_view value, std::uint64_t hash) const;
+  const char* store(std::string_view value);
+  void growIndex();
+};
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef VERSIONED_DICTIONARY_H
+#define VERSIONED_DICTIONARY_H
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "Dictionary.h"
+
+namespace detail
+{
+  // Directory depth of a new version (16 slots), and the number of words a
+  // segment holds before an insert splits it.
+  static const unsigned VERSION_MIN_DEPTH = 4;
+  static const std::size_t VERSION_SEGMENT_CAPACITY = 64;
+
+  struct VersionEntry
+  {
+    std::size_t hash;
+    std::string word;
+    TranslationList<std::allocator> translations;
+  };
+
+  // Words whose hashes share their top depth bits, sorted by hash. A
+  // directory of depth D points 2^(D - depth) consecutive slots at the
+  // segment, and sorting makes splitting it one partition point.
+  struct VersionSegment
+  {
+    unsigned depth = 0;
+    std::vector<VersionEntry> entries;
+  };
+}
+
+
+// One immutable state of a VersionedDictionary. The words are spread over
+// segments by extendible hashing: the top bits of a word's hash index a
+// directory, and a segment that has split fewer times than the directory has
+// doubled is shared by several slots. Segments are held by shared pointer, so
+// a version made by editing another shares every segment the edits did not
+// touch, growth included. Any number of threads may read a version while
+// others edit and publish newer ones.
+class DictionaryVersion
+{
+public:
+  using TranslationList = detail::TranslationList<std::allocator>;
+
+  DictionaryVersion();
+
+  const TranslationList* find(std::string_view word) const;
+  bool contains(std::string_view word) const;
+  template <class F>
+  void forEach(F&& f) const;
+  std::size_t size() const;
+  bool empty() const;
+  std::size_t segmentCount() const;
+  std::size_t sharedSegments(const DictionaryVersion& other) const;
+
+private:
+  friend class DictionaryEditor;
+
+  std::vector<std::shared_ptr<detail::VersionSegment>> segments_;
+  std::size_t size_;
+  unsigned depth_;
+
+  std::size_t segmentIndex(std::size_t hash) const;
+  template <class F>
+  void forEachSegment(F&& f) const;
+};
+
+
+// Builds the next version from a base one. Only the segments an edit touches
+// are copied, once per commit, and a full segment splits on its own; the base
+// and every version committed earlier stay as they were. An editor is used by
+// one thread at a time.
+class DictionaryEditor
+{
+public:
+  using TranslationList = DictionaryVersion::TranslationList;
+
+  explicit DictionaryEditor(std::shared_ptr<const DictionaryVersion> base = nullptr);
+
+  void insert(const std::string& word, const std::string& translation);
+  void remove(std::string_view word, std::string_view translation);
+  bool remove(std::string_view word);
+  void clear();
+  const DictionaryVersion& version() const;
+  std::shared_ptr<const DictionaryVersion> commit();
+
+private:
+  std::shared_ptr<const DictionaryVersion> base_;
+  std::shared_ptr<DictionaryVersion> next_;
+
+  // Segments of next_ that were copied or made since the last commit and are
+  // not shared with any other version.
+  std::unordered_set<const detail::VersionSegment*> owned_;
+
+  DictionaryVersion& edit();
+  detail::VersionSegment& ownSegment(std::size_t index);
+  void split(std::size_t index);
+  void pointSlots(std::size_t index, unsigned depth, const std::shared_ptr<detail::VersionSegment>& segment);
+};
+
+
+// Holds the current version for readers and swaps in new ones atomically.
+// snapshot() is a reference count increment, and a reader sees either all of
+// an update or none of it however long it keeps its snapshot. Writers either
+// go through update(), which serializes them, or pair edit() and publish()
+// under their own lock; publish() replaces whatever was current.
+class VersionedDictionary
+{
+public:
+  VersionedDictionary();
+  VersionedDictionary(const VersionedDictionary&) = delete;
+  VersionedDictionary& operator=(const VersionedDictionary&) = delete;
+
+  std::shared_ptr<const DictionaryVersion> snapshot() const;
+  DictionaryEditor edit() const;
+  void publish(std::shared_ptr<const DictionaryVersion> version);
+  template <class F>
+  void update(F&& f);
+
+private:
+  std::shared_ptr<const DictionaryVersion> current_;
+  std::mutex writeMutex_;
+};
+
+
+// Calls f(word, translations) for every word, in hash order.
+template <class F>
+void DictionaryVersion::forEach(F&& f) const
+{
+  forEachSegment([&f](const detail::VersionSegment& segment)
+  {
+    for (const detail::VersionEntry& entry : segment.entries)
+    {
+      f(std::string_view(entry.word), entry.translations);
+    }
+  });
+}
+
+// Calls f(segment) once for every distinct segment. The slots of a segment
+// are consecutive, so a repeat is always the previous slot's.
+template <class F>
+void DictionaryVersion::forEachSegment(F&& f) const
+{
+  const detail::VersionSegment* previous = nullptr;
+  for (const std::shared_ptr<detail::VersionSegment>& segment : segments_)
+  {
+    if (segment.get() != previous)
+    {
+      f(*segment);
+      previous = segment.get();
+    }
+  }
+}
+
+// Calls f(DictionaryEditor&) on an editor of the current version and
+// publishes the result, holding off other update() calls meanwhile.
+template <class F>
+void VersionedDictionary::update(F&& f)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  DictionaryEditor editor = edit();
+  f(editor);
+  publish(editor.commit());
+}
+
+#endif
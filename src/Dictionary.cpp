@@ -1,30 +1,49 @@
 #include "../include/Dictionary.h"
+#include "../include/DictionarySnapshot.h"
 
 
-Dictionary::Dictionary(std::size_t capacity) : HashMap::HashMap(capacity)
+template <class Storage, template <class> class Allocator>
+BasicDictionary<Storage, Allocator>::BasicDictionary(std::size_t capacity) : BaseType(capacity)
 {}
 
-void Dictionary::insert(const std::string& key, const std::string& value)
+// Builds a string only for a word or translation that is not there yet.
+template <class Storage, template <class> class Allocator>
+void BasicDictionary<Storage, Allocator>::insert(std::string_view key, std::string_view value)
 {
-  iterator pair_it = find(key);
-  if (pair_it != end())
+  TranslationList& translations = this->emplace(key, this->getAllocator()).first->second;
+  if (!translations.contains(value))
   {
-    SortedUniqueList<std::string>& lst = pair_it->second;
-    lst.insert(value);
+    translations.emplace(value);
   }
-  else
+}
+
+template <class Storage, template <class> class Allocator>
+void BasicDictionary<Storage, Allocator>::remove(std::string_view key, std::string_view value)
+{
+  auto pair_it = this->find(key);
+  if (pair_it != this->end() && pair_it->second.remove(value) && pair_it->second.empty())
   {
-    SortedUniqueList<std::string> lst;
-    lst.insert(value);
-    HashMap::insert(key, lst);
+    BaseType::remove(key);
   }
 }
 
-void Dictionary::remove(const std::string& key, const std::string& value)
+// Writes the dictionary in the format read by DictionarySnapshot.
+template <class Storage, template <class> class Allocator>
+void BasicDictionary<Storage, Allocator>::saveSnapshot(const std::string& path) const
 {
-  auto pair_it = find(key);
-  if (pair_it != end() && pair_it->second.remove(value) && pair_it->second.empty())
+  detail::SnapshotWriter writer(this->size());
+  for (auto it = this->cbegin(); it != this->cend(); ++it)
   {
-    HashMap::remove(key);
+    writer.addWord(it->first);
+    for (auto translation = it->second.cbegin(); translation != it->second.cend(); ++translation)
+    {
+      writer.addTranslation(*translation);
+    }
   }
+  writer.save(path);
 }
+
+template class BasicDictionary<detail::ChainedStorage>;
+template class BasicDictionary<detail::FlatStorage>;
+template class BasicDictionary<detail::DenseStorage>;
+template class BasicDictionary<detail::ChainedStorage, PoolAllocator>;
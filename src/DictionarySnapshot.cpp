@@ -0,0 +1,332 @@
+#include "../include/DictionarySnapshot.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#include "../include/Hash.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+  const std::size_t SNAPSHOT_ALIGNMENT = 8;
+
+  std::uint64_t alignUp(std::uint64_t value)
+  {
+    return (value + SNAPSHOT_ALIGNMENT - 1) & ~static_cast<std::uint64_t>(SNAPSHOT_ALIGNMENT - 1);
+  }
+
+  // True when [offset, offset + count * size) lies inside a file of fileSize
+  // bytes, without overflowing.
+  bool sectionFits(std::uint64_t offset, std::uint64_t count, std::uint64_t size, std::uint64_t fileSize)
+  {
+    return offset <= fileSize && count <= (fileSize - offset) / size;
+  }
+
+  void writeBytes(std::ofstream& file, const void* data, std::size_t size)
+  {
+    file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+  }
+
+  void writePadding(std::ofstream& file, std::uint64_t written)
+  {
+    static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+    writeBytes(file, zeros, static_cast<std::size_t>(alignUp(written) - written));
+  }
+}
+
+namespace detail
+{
+  SnapshotWriter::SnapshotWriter(std::size_t wordCount)
+  {
+    entries_.reserve(wordCount);
+    strings_.reserve(wordCount);
+  }
+
+  std::uint64_t SnapshotWriter::appendString(std::string_view value)
+  {
+    std::uint64_t offset = arena_.size();
+    arena_.append(value.data(), value.size());
+    return offset;
+  }
+
+  void SnapshotWriter::addWord(std::string_view word)
+  {
+    if (word.size() >= SNAPSHOT_EMPTY_SLOT)
+    {
+      throw std::length_error("Word is too long for a dictionary snapshot.");
+    }
+
+    SnapshotSlot entry;
+    entry.hash = hashBytes(word.data(), word.size());
+    entry.keyOffset = appendString(word);
+    entry.translationsBegin = strings_.size();
+    entry.keyLength = static_cast<std::uint32_t>(word.size());
+    entry.translationCount = 0;
+    entries_.push_back(entry);
+  }
+
+  void SnapshotWriter::addTranslation(std::string_view translation)
+  {
+    if (entries_.empty())
+    {
+      throw std::logic_error("Translation added before any word.");
+    }
+    if (entries_.back().translationCount == std::numeric_limits<std::uint32_t>::max())
+    {
+      throw std::length_error("Too many translations for a dictionary snapshot.");
+    }
+
+    SnapshotString string;
+    string.offset = appendString(translation);
+    string.length = translation.size();
+    strings_.push_back(string);
+    ++entries_.back().translationCount;
+  }
+
+  // Writes to a temporary file first and renames it over path, so readers
+  // that map path never see a half-written snapshot.
+  void SnapshotWriter::save(const std::string& path) const
+  {
+    std::uint64_t slotCount = 8;
+    while (slotCount < entries_.size() * 2)
+    {
+      slotCount <<= 1;
+    }
+
+    SnapshotSlot emptySlot = {};
+    emptySlot.keyLength = SNAPSHOT_EMPTY_SLOT;
+    std::vector<SnapshotSlot> slots(static_cast<std::size_t>(slotCount), emptySlot);
+    for (const SnapshotSlot& entry : entries_)
+    {
+      std::size_t index = static_cast<std::size_t>(entry.hash & (slotCount - 1));
+      while (slots[index].keyLength != SNAPSHOT_EMPTY_SLOT)
+      {
+        index = (index + 1) & (slotCount - 1);
+      }
+      slots[index] = entry;
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.entryCount = entries_.size();
+    header.slotCount = slotCount;
+    header.slotsOffset = alignUp(sizeof(SnapshotHeader));
+    header.stringCount = strings_.size();
+    header.stringsOffset = header.slotsOffset + slotCount * sizeof(SnapshotSlot);
+    header.arenaSize = arena_.size();
+    header.arenaOffset = header.stringsOffset + strings_.size() * sizeof(SnapshotString);
+
+    std::string tempPath = path + ".tmp";
+    {
+      std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+      if (!file.is_open())
+      {
+        throw std::runtime_error("Could not create snapshot file '" + tempPath + "'.");
+      }
+      writeBytes(file, &header, sizeof(header));
+      writePadding(file, sizeof(header));
+      writeBytes(file, slots.data(), slots.size() * sizeof(SnapshotSlot));
+      writeBytes(file, strings_.data(), strings_.size() * sizeof(SnapshotString));
+      writeBytes(file, arena_.data(), arena_.size());
+      file.flush();
+      if (!file)
+      {
+        throw std::runtime_error("Could not write snapshot file '" + tempPath + "'.");
+      }
+    }
+    std::filesystem::rename(tempPath, path);
+  }
+}
+
+
+DictionarySnapshot::DictionarySnapshot(const std::string& path)
+  : data_(nullptr), fileSize_(0), header_(nullptr), slots_(nullptr), strings_(nullptr), arena_(nullptr)
+{
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+    FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    throw std::runtime_error("Could not open snapshot file '" + path + "'.");
+  }
+  LARGE_INTEGER size;
+  HANDLE mapping = nullptr;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+  {
+    fileSize_ = static_cast<std::size_t>(size.QuadPart);
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  }
+  if (mapping != nullptr)
+  {
+    data_ = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    CloseHandle(mapping);
+  }
+  CloseHandle(file);
+#else
+  int file = ::open(path.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    throw std::runtime_error("Could not open snapshot file '" + path + "'.");
+  }
+  struct stat status;
+  if (::fstat(file, &status) == 0 && status.st_size > 0)
+  {
+    fileSize_ = static_cast<std::size_t>(status.st_size);
+    void* mapped = ::mmap(nullptr, fileSize_, PROT_READ, MAP_SHARED, file, 0);
+    data_ = mapped == MAP_FAILED ? nullptr : static_cast<const char*>(mapped);
+  }
+  ::close(file);
+#endif
+
+  if (data_ == nullptr)
+  {
+    throw std::runtime_error("Could not map snapshot file '" + path + "'.");
+  }
+
+  try
+  {
+    validate(path);
+  }
+  catch (...)
+  {
+    unmap();
+    throw;
+  }
+}
+
+DictionarySnapshot::~DictionarySnapshot()
+{
+  unmap();
+}
+
+DictionarySnapshot::DictionarySnapshot(DictionarySnapshot&& other) noexcept
+  : data_(other.data_), fileSize_(other.fileSize_), header_(other.header_), slots_(other.slots_),
+    strings_(other.strings_), arena_(other.arena_)
+{
+  other.data_ = nullptr;
+  other.fileSize_ = 0;
+}
+
+DictionarySnapshot& DictionarySnapshot::operator=(DictionarySnapshot&& other) noexcept
+{
+  if (this != &other)
+  {
+    unmap();
+    data_ = other.data_;
+    fileSize_ = other.fileSize_;
+    header_ = other.header_;
+    slots_ = other.slots_;
+    strings_ = other.strings_;
+    arena_ = other.arena_;
+    other.data_ = nullptr;
+    other.fileSize_ = 0;
+  }
+  return *this;
+}
+
+void DictionarySnapshot::validate(const std::string& path)
+{
+  const detail::SnapshotHeader* header = reinterpret_cast<const detail::SnapshotHeader*>(data_);
+  bool valid = fileSize_ >= sizeof(detail::SnapshotHeader)
+    && std::memcmp(header->magic, detail::SNAPSHOT_MAGIC, sizeof(header->magic)) == 0
+    && header->version == detail::SNAPSHOT_VERSION
+    && header->byteOrder == detail::SNAPSHOT_BYTE_ORDER
+    && header->slotCount != 0 && (header->slotCount & (header->slotCount - 1)) == 0
+    && header->entryCount < header->slotCount
+    && header->slotsOffset % SNAPSHOT_ALIGNMENT == 0 && header->stringsOffset % SNAPSHOT_ALIGNMENT == 0
+    && sectionFits(header->slotsOffset, header->slotCount, sizeof(detail::SnapshotSlot), fileSize_)
+    && sectionFits(header->stringsOffset, header->stringCount, sizeof(detail::SnapshotString), fileSize_)
+    && sectionFits(header->arenaOffset, header->arenaSize, 1, fileSize_);
+  if (!valid)
+  {
+    throw std::runtime_error("File '" + path + "' is not a valid dictionary snapshot.");
+  }
+
+  header_ = header;
+  slots_ = reinterpret_cast<const detail::SnapshotSlot*>(data_ + header->slotsOffset);
+  strings_ = reinterpret_cast<const detail::SnapshotString*>(data_ + header->stringsOffset);
+  arena_ = data_ + header->arenaOffset;
+}
+
+void DictionarySnapshot::unmap()
+{
+  if (data_ == nullptr)
+  {
+    return;
+  }
+#if defined(_WIN32)
+  UnmapViewOfFile(data_);
+#else
+  ::munmap(const_cast<char*>(data_), fileSize_);
+#endif
+  data_ = nullptr;
+}
+
+// Entries are read straight from the mapping; offsets that point outside
+// their section mean the file was damaged after it was opened.
+SnapshotTranslations DictionarySnapshot::find(std::string_view word) const
+{
+  std::uint64_t hash = detail::hashBytes(word.data(), word.size());
+  std::uint64_t mask = header_->slotCount - 1;
+  for (std::uint64_t index = hash & mask, probes = 0; probes < header_->slotCount; index = (index + 1) & mask, probes++)
+  {
+    const detail::SnapshotSlot& slot = slots_[index];
+    if (slot.keyLength == detail::SNAPSHOT_EMPTY_SLOT)
+    {
+      break;
+    }
+    if (slot.hash != hash || slot.keyLength != word.size())
+    {
+      continue;
+    }
+
+    if (!sectionFits(slot.keyOffset, slot.keyLength, 1, header_->arenaSize)
+      || !sectionFits(slot.translationsBegin, slot.translationCount, 1, header_->stringCount))
+    {
+      throw std::runtime_error("Dictionary snapshot is corrupted.");
+    }
+    if (std::memcmp(arena_ + slot.keyOffset, word.data(), word.size()) == 0)
+    {
+      const detail::SnapshotString* strings = strings_ + slot.translationsBegin;
+      for (std::uint32_t i = 0; i < slot.translationCount; i++)
+      {
+        if (!sectionFits(strings[i].offset, strings[i].length, 1, header_->arenaSize))
+        {
+          throw std::runtime_error("Dictionary snapshot is corrupted.");
+        }
+      }
+      return SnapshotTranslations(strings, slot.translationCount, arena_);
+    }
+  }
+  return SnapshotTranslations();
+}
+
+bool DictionarySnapshot::contains(std::string_view word) const
+{
+  return !find(word).empty();
+}
+
+std::size_t DictionarySnapshot::size() const
+{
+  return static_cast<std::size_t>(header_->entryCount);
+}
+
+bool DictionarySnapshot::empty() const
+{
+  return size() == 0;
+}
@@ -2,7 +2,7 @@
 
 namespace detail
 {
-  size_t StringHash::operator()(const std::string& key) const
+  size_t OneAtATimeHash::operator()(const std::string& key) const
   {
     size_t hash = 0;
 
@@ -0,0 +1,105 @@
+#include "../include/InternedDictionary.h"
+
+#include <utility>
+
+
+InternedDictionary::InternedDictionary(std::size_t capacity)
+{
+  slots_.reserve(capacity);
+  words_.reserve(capacity);
+  translations_.reserve(capacity);
+}
+
+void InternedDictionary::insert(std::string_view word, std::string_view translation)
+{
+  StringId wordId = pool_.intern(word);
+  StringId translationId = pool_.intern(translation);
+  if (slots_.size() <= wordId)
+  {
+    slots_.resize(static_cast<std::size_t>(wordId) + 1, detail::NO_WORD_SLOT);
+  }
+
+  std::uint32_t& slot = slots_[wordId];
+  if (slot == detail::NO_WORD_SLOT)
+  {
+    slot = static_cast<std::uint32_t>(words_.size());
+    words_.push_back(wordId);
+    translations_.emplace_back();
+  }
+  translations_[slot].insert(translationId);
+}
+
+// Only looks the strings up: removing never adds to the pool. A word left
+// without translations hands its slot to the last word, so slots stay packed.
+void InternedDictionary::remove(std::string_view word, std::string_view translation)
+{
+  StringId wordId;
+  StringId translationId;
+  if (!pool_.find(word, wordId) || wordId >= slots_.size() || slots_[wordId] == detail::NO_WORD_SLOT
+    || !pool_.find(translation, translationId))
+  {
+    return;
+  }
+
+  std::uint32_t slot = slots_[wordId];
+  if (translations_[slot].remove(translationId) && translations_[slot].empty())
+  {
+    if (slot + 1 != words_.size())
+    {
+      words_[slot] = words_.back();
+      translations_[slot] = std::move(translations_.back());
+      slots_[words_[slot]] = slot;
+    }
+    words_.pop_back();
+    translations_.pop_back();
+    slots_[wordId] = detail::NO_WORD_SLOT;
+  }
+}
+
+InternedTranslations InternedDictionary::find(std::string_view word) const
+{
+  const TranslationIds* ids = findTranslations(word);
+  if (ids == nullptr)
+  {
+    return InternedTranslations();
+  }
+  return InternedTranslations(ids->begin(), ids->size(), &pool_);
+}
+
+bool InternedDictionary::contains(std::string_view word) const
+{
+  return findTranslations(word) != nullptr;
+}
+
+void InternedDictionary::clear()
+{
+  slots_.clear();
+  words_.clear();
+  translations_.clear();
+  pool_.clear();
+}
+
+std::size_t InternedDictionary::size() const
+{
+  return words_.size();
+}
+
+bool InternedDictionary::empty() const
+{
+  return words_.empty();
+}
+
+const StringPool& InternedDictionary::strings() const
+{
+  return pool_;
+}
+
+const InternedDictionary::TranslationIds* InternedDictionary::findTranslations(std::string_view word) const
+{
+  StringId wordId;
+  if (!pool_.find(word, wordId) || wordId >= slots_.size() || slots_[wordId] == detail::NO_WORD_SLOT)
+  {
+    return nullptr;
+  }
+  return &translations_[slots_[wordId]];
+}
@@ -1,9 +1,9 @@
 ﻿#include <iostream>
-#include <fstream>
-#include <sstream>
 #include <limits>
+#include <string>
+#include <string_view>
 #include "../include/Dictionary.h"
-#include "../include/LinkedList.h"
+#include "../include/DictionaryParser.h"
 
 
 void loadDictionaryFromFile(Dictionary& dict);
@@ -12,21 +12,15 @@ void addTranslation(Dictionary& dict);
 void searchTranslation(Dictionary& dict);
 void removeTranslation(Dictionary& dict);
 
-void printList(const SortedUniqueList<std::string>& lst);
+void printList(const Dictionary::TranslationList& lst);
 void printDictionary(const Dictionary& dict, std::size_t entriesPerPage = 5);
 
-void runTests();
-void testDictionary();
-void testSortedUniqueList();
-
 int main()
 {
   // std::system("chcp 1251 > nul");  // Поддержка кириллицы в Windows
   Dictionary dict;
   bool keepRunning = true;
 
-  runTests();
-
   while (keepRunning)
   {
     std::cout << "\n=== DICTIONARY MENU ===\n"
@@ -74,37 +68,53 @@ void loadDictionaryFromFile(Dictionary& dict)
   std::cout << "Enter filename: ";
   std::getline(std::cin, filename);
 
-  std::ifstream file(filename);
-  if (!file.is_open())
+  ParseStats stats;
+  try
   {
-    std::cerr << "Error: Could not open file '" << filename << "'.\n";
-    return;
+    stats = parseDictionaryFile(filename,
+      [&dict](std::string_view word, std::string_view translation)
+      {
+        dict.insert(word, translation);
+      },
+      [](std::string_view line)
+      {
+        std::cerr << "Error: Invalid format in line: " << line << "\n";
+      });
   }
-
-  std::string line, englishWord, russianWord;
-  while (std::getline(file, line))
+  catch (const std::runtime_error& e)
   {
-    std::istringstream iss(line);
-    if (std::getline(iss, englishWord, '-') && std::getline(iss, russianWord))
-    {
-      englishWord.erase(englishWord.find_last_not_of(" ") + 1);
-      russianWord.erase(0, russianWord.find_first_not_of(" "));
-      dict.insert(englishWord, russianWord);
-    }
-    else
-    {
-      std::cerr << "Error: Invalid format in line: " << line << "\n";
-    }
+    std::cerr << "Error: " << e.what() << "\n";
+    return;
   }
 
-  std::cout << "Dictionary successfully loaded from '" << filename << "'.\n";
+  std::cout << "Dictionary successfully loaded from '" << filename << "'.\n"
+    << "Parsed " << stats.lines << " lines (" << stats.entries << " entries, " << stats.malformed
+    << " malformed) at " << stats.megabytesPerSecond() << " MB/s.\n";
 }
 
 void showDictionaryStats(const Dictionary& dict)
 {
   std::cout << "\n--- DICTIONARY STATISTICS ---\n";
   std::cout << "Total Entries: " << dict.size() << "\n";
-  std::cout << "Load Factor: " << dict.loadFactor() << "%\n";
+  std::cout << "Load Factor: " << dict.loadFactor() << "\n";
+#if defined(HASHMAP_ENABLE_STATS)
+  HashMapStats stats = dict.stats();
+  std::cout << "Buckets: " << stats.bucketCount << " (" << stats.emptyBuckets << " empty)\n";
+  std::cout << "Longest Chain: " << stats.maxLength << "\n";
+  std::cout << "Chain Lengths:";
+  for (std::size_t length = 0; length < detail::STATS_HISTOGRAM_SIZE; length++)
+  {
+    if (stats.lengthHistogram[length] != 0)
+    {
+      std::cout << " " << length << (length + 1 == detail::STATS_HISTOGRAM_SIZE ? "+" : "") << ":"
+        << stats.lengthHistogram[length];
+    }
+  }
+  std::cout << "\n";
+  std::cout << "Rehashes: " << stats.rehashCount << " (" << stats.rehashSeconds * 1000.0 << " ms)\n";
+  std::cout << "Memory: " << stats.totalBytes() << " bytes (buckets " << stats.bucketBytes << ", nodes "
+    << stats.nodeBytes << ", strings " << stats.elementBytes << ")\n";
+#endif
 }
 
 void addTranslation(Dictionary& dict)
@@ -149,14 +159,6 @@ void removeTranslation(Dictionary& dict)
   std::cout << "Translation removed (if it existed).\n";
 }
 
-void runTests()
-{
-  std::cout << "\nRunning basic tests...\n";
-  testDictionary();
-  testSortedUniqueList();
-  std::cout << "Tests completed.\n";
-}
-
 void printDictionary(const Dictionary& dict, std::size_t entriesPerPage)
 {
   if (dict.empty())
@@ -199,7 +201,7 @@ void printDictionary(const Dictionary& dict, std::size_t entriesPerPage)
   }
 }
 
-void printList(const SortedUniqueList<std::string>& lst)
+void printList(const Dictionary::TranslationList& lst)
 {
   for (auto it = lst.cbegin(); it != lst.cend(); ++it)
   {
@@ -207,115 +209,3 @@ void printList(const SortedUniqueList<std::string>& lst)
   }
   std::cout << "\n";
 }
-
-void testDictionary()
-{
-  Dictionary dict;
-
-  // Test 1: Insert elements
-  dict.insert("hello", "привет");
-  dict.insert("world", "мир");
-  dict.insert("world", "земля");
-
-  assert(dict.size() == 2);
-  assert(dict.find("hello") != dict.end());
-  assert(dict.find("world")->second.size() == 2);
-
-  // Test 2: Remove specific translation
-  dict.remove("world", "земля");
-  auto translations = dict.find("world");
-  assert(translations->second.size() == 1);
-
-  // Test 3: Remove key entirely
-  dict.remove("hello", "привет");
-  assert(dict.find("hello") == dict.end());
-
-  // Test 4: Handle non-existing keys
-  dict.remove("nonexistent", "value");
-  assert(dict.size() == 1);
-
-  // Test 5: Load factor
-  dict.insert("key1", "value1");
-  dict.insert("key2", "value2");
-  assert(dict.loadFactor() > 0 && dict.loadFactor() <= 1);
-
-  // Test 6: Clear dictionary
-  dict.clear();
-  assert(dict.empty());
-
-  // Test 7: Re-insertion after clearing
-  dict.insert("test", "тест");
-  assert(dict.size() == 1);
-
-  // Test 8: Handling duplicate insertions
-  dict.insert("test", "тест");
-  dict.insert("test", "пример");
-  translations = dict.find("test");
-  assert(translations->second.size() == 2);
-
-  // Test 9: Edge cases for empty dictionary
-  dict.clear();
-  assert(dict.empty());
-  assert(dict.find("nonexistent") == dict.end());
-
-  std::cout << "All Dictionary tests completed successfully.\n";
-}
-
-void testSortedUniqueList()
-{
-  SortedUniqueList<int> list;
-
-  // Test 1: Insert elements
-  assert(list.insert(5));   // OK
-  assert(list.insert(3));   // OK
-  assert(list.insert(8));   // OK
-  assert(!list.insert(5));  // duplicate!
-
-  auto it = list.cbegin();
-  assert(*it++ == 3);
-  assert(*it++ == 5);
-  assert(*it++ == 8);
-  assert(it == list.cend());
-
-  // Test 2: Remove an element
-  assert(list.remove(5));
-  assert(!list.remove(5));
-
-  it = list.cbegin();
-  assert(*it++ == 3);
-  assert(*it++ == 8);
-  assert(it == list.cend());
-
-  // Test 3: Check empty and size
-  assert(!list.empty());
-  assert(list.size() == 2);
-
-  // Test 4: Clear the list
-  list.clear();
-  assert(list.empty());
-  assert(list.size() == 0);
-
-  // Test 5: Insert after clearing
-  assert(list.insert(10));
-  assert(list.insert(1));
-  assert(list.insert(5));
-
-  it = list.cbegin();
-  assert(*it++ == 1);
-  assert(*it++ == 5);
-  assert(*it++ == 10);
-  assert(it == list.cend());
-
-  // Test 6: Handling negative and duplicate values
-  assert(list.insert(-1));
-  assert(!list.insert(-1));
-
-  it = list.cbegin();
-  assert(*it++ == -1);
-  assert(*it++ == 1);
-  assert(*it++ == 5);
-  assert(*it++ == 10);
-  assert(it == list.cend());
-
-  std::cout << "All SortedUniqueList tests passed successfully.\n";
-}
@@ -0,0 +1,293 @@
+#include "../include/StaticDictionary.h"
+
+#include <algorithm>
+#include <cctype>
+#include <limits>
+#include <numeric>
+#include <utility>
+
+namespace
+{
+  // Prints value as a string_view of a literal that means the same bytes on
+  // any compiler: everything outside printable ASCII is an octal escape, which
+  // unlike \x stops after three digits.
+  void writeLiteral(std::ostream& out, std::string_view value)
+  {
+    static const char DIGITS[] = "01234567";
+    out << "std::string_view(\"";
+    for (char c : value)
+    {
+      unsigned char byte = static_cast<unsigned char>(c);
+      if (c == '"' || c == '\\')
+      {
+        out << '\\' << c;
+      }
+      else if (byte < 0x20 || byte >= 0x7f)
+      {
+        out << '\\' << DIGITS[byte >> 6] << DIGITS[(byte >> 3) & 7] << DIGITS[byte & 7];
+      }
+      else
+      {
+        out << c;
+      }
+    }
+    out << "\", " << value.size() << ")";
+  }
+}
+
+
+StaticDictionary::const_iterator StaticDictionary::find(std::string_view word) const
+{
+  if (size_ == 0)
+  {
+    return end();
+  }
+  std::uint64_t hash = detail::hashBytes(word.data(), word.size(), seed_);
+  std::uint32_t pilot = pilots_[detail::fastRange(hash, bucketCount_)];
+  const detail::StaticEntry* entry = entries_ + detail::staticSlot(hash, pilot, size_);
+  return entry->hash == hash && entry->first == word ? entry : end();
+}
+
+bool StaticDictionary::contains(std::string_view word) const
+{
+  return find(word) != end();
+}
+
+std::size_t StaticDictionary::size() const
+{
+  return size_;
+}
+
+bool StaticDictionary::empty() const
+{
+  return size_ == 0;
+}
+
+StaticDictionary::const_iterator StaticDictionary::begin() const
+{
+  return entries_;
+}
+
+StaticDictionary::const_iterator StaticDictionary::end() const
+{
+  return entries_ + size_;
+}
+
+StaticDictionary::const_iterator StaticDictionary::cbegin() const
+{
+  return begin();
+}
+
+StaticDictionary::const_iterator StaticDictionary::cend() const
+{
+  return end();
+}
+
+
+void StaticDictionaryBuilder::insert(const std::string& word, const std::string& translation)
+{
+  words_.insert(word, translation);
+}
+
+std::size_t StaticDictionaryBuilder::size() const
+{
+  return words_.size();
+}
+
+StaticDictionary StaticDictionaryBuilder::build()
+{
+  std::vector<const Dictionary::PairType*> words;
+  words.reserve(words_.size());
+  for (auto it = words_.cbegin(); it != words_.cend(); ++it)
+  {
+    words.push_back(&*it);
+  }
+
+  std::size_t count = words.size();
+  std::size_t bucketCount = count == 0 ? 0 : (count + detail::STATIC_BUCKET_SIZE - 1) / detail::STATIC_BUCKET_SIZE;
+  std::vector<std::uint64_t> hashes(count);
+  std::vector<std::size_t> slots(count);
+  for (seed_ = 0;; seed_++)
+  {
+    pilots_.assign(bucketCount, 0);
+    for (std::size_t i = 0; i < count; i++)
+    {
+      hashes[i] = detail::hashBytes(words[i]->first.data(), words[i]->first.size(), seed_);
+    }
+    if (findPilots(hashes, slots))
+    {
+      break;
+    }
+  }
+
+  std::vector<std::size_t> order(count);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    order[slots[i]] = i;
+  }
+
+  // Fill the arena first: views into it are only stable once it stops growing.
+  std::vector<std::pair<std::size_t, std::size_t>> strings;
+  arena_.clear();
+  for (std::size_t slot = 0; slot < count; slot++)
+  {
+    const Dictionary::PairType& word = *words[order[slot]];
+    strings.emplace_back(arena_.size(), word.first.size());
+    arena_ += word.first;
+    for (const std::string& translation : word.second)
+    {
+      strings.emplace_back(arena_.size(), translation.size());
+      arena_ += translation;
+    }
+  }
+
+  translations_.clear();
+  entries_.clear();
+  translations_.reserve(strings.size() - count);
+  entries_.reserve(count);
+  auto range = strings.begin();
+  for (std::size_t slot = 0; slot < count; slot++, ++range)
+  {
+    std::string_view word(arena_.data() + range->first, range->second);
+    std::size_t first = translations_.size();
+    std::size_t translationCount = words[order[slot]]->second.size();
+    for (std::size_t i = 0; i < translationCount; i++)
+    {
+      ++range;
+      translations_.emplace_back(arena_.data() + range->first, range->second);
+    }
+    entries_.push_back(detail::StaticEntry{ word, StaticTranslations(translations_.data() + first, translationCount),
+      hashes[order[slot]] });
+  }
+
+  return StaticDictionary(entries_.data(), count, pilots_.data(), pilots_.size(), seed_);
+}
+
+// Declares the dictionary generated as name.
+void StaticDictionaryBuilder::writeHeader(std::ostream& out, const std::string& name) const
+{
+  std::string guard = "STATIC_DICTIONARY_" + name + "_H";
+  std::transform(guard.begin(), guard.end(), guard.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+
+  out << "// Generated by static_dictionary_gen; do not edit.\n"
+    << "#ifndef " << guard << "\n"
+    << "#define " << guard << "\n\n"
+    << "#include \"StaticDictionary.h\"\n\n"
+    << "extern const StaticDictionary " << name << ";\n\n"
+    << "#endif\n";
+}
+
+// Defines name over the tables of the last build(), as constant data that
+// needs no initialization at startup.
+void StaticDictionaryBuilder::writeSource(std::ostream& out, const std::string& name) const
+{
+  out << "// Generated by static_dictionary_gen; do not edit.\n"
+    << "#include \"" << name << ".h\"\n\n";
+  if (entries_.empty())
+  {
+    out << "constexpr StaticDictionary " << name << "{};\n";
+    return;
+  }
+
+  out << "namespace\n{\n  constexpr std::string_view TRANSLATIONS[] = {\n";
+  for (std::string_view translation : translations_)
+  {
+    out << "    ";
+    writeLiteral(out, translation);
+    out << ",\n";
+  }
+  out << "  };\n\n  constexpr detail::StaticEntry ENTRIES[] = {\n";
+  for (const detail::StaticEntry& entry : entries_)
+  {
+    out << "    { ";
+    writeLiteral(out, entry.first);
+    out << ", StaticTranslations(TRANSLATIONS + " << (entry.second.begin() - translations_.data()) << ", "
+      << entry.second.size() << "), " << entry.hash << "ull },\n";
+  }
+  out << "  };\n\n  constexpr std::uint32_t PILOTS[] = {";
+  for (std::size_t i = 0; i < pilots_.size(); i++)
+  {
+    out << (i % 16 == 0 ? "\n    " : " ") << pilots_[i] << ",";
+  }
+  out << "\n  };\n}\n\n"
+    << "constexpr StaticDictionary " << name << "(ENTRIES, " << entries_.size() << ", PILOTS, " << pilots_.size()
+    << ", " << seed_ << "ull);\n";
+}
+
+// PTHash search: buckets are placed largest first, each with the smallest
+// pilot that sends all of its words to distinct free slots. Fails, so that
+// build() retries with another seed, only if a bucket holds two equal hashes
+// or runs out of pilots.
+bool StaticDictionaryBuilder::findPilots(const std::vector<std::uint64_t>& hashes, std::vector<std::size_t>& slots)
+{
+  std::size_t count = hashes.size();
+  std::size_t bucketCount = pilots_.size();
+  std::vector<std::size_t> bucketStart(bucketCount + 1, 0);
+  for (std::uint64_t hash : hashes)
+  {
+    bucketStart[detail::fastRange(hash, bucketCount) + 1]++;
+  }
+  std::partial_sum(bucketStart.begin(), bucketStart.end(), bucketStart.begin());
+
+  std::vector<std::size_t> members(count);
+  std::vector<std::size_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+  for (std::size_t i = 0; i < count; i++)
+  {
+    members[cursor[detail::fastRange(hashes[i], bucketCount)]++] = i;
+  }
+
+  std::vector<std::size_t> buckets(bucketCount);
+  std::iota(buckets.begin(), buckets.end(), 0);
+  std::stable_sort(buckets.begin(), buckets.end(), [&bucketStart](std::size_t a, std::size_t b)
+  {
+    return bucketStart[a + 1] - bucketStart[a] > bucketStart[b + 1] - bucketStart[b];
+  });
+
+  // The last free slot takes count tries on average, so this many failures in
+  // a row mean the bucket cannot be placed.
+  std::uint64_t maxPilot = std::min<std::uint64_t>(std::numeric_limits<std::uint32_t>::max(),
+    std::max<std::uint64_t>(1 << 16, static_cast<std::uint64_t>(count) * 64));
+
+  std::vector<bool> taken(count, false);
+  std::vector<std::size_t> candidate;
+  for (std::size_t bucket : buckets)
+  {
+    std::size_t first = bucketStart[bucket];
+    std::size_t last = bucketStart[bucket + 1];
+    if (first == last)
+    {
+      break;
+    }
+
+    std::uint64_t pilot = 0;
+    for (;; pilot++)
+    {
+      if (pilot == maxPilot)
+      {
+        return false;
+      }
+      candidate.clear();
+      for (std::size_t i = first; i < last; i++)
+      {
+        std::size_t slot = detail::staticSlot(hashes[members[i]], static_cast<std::uint32_t>(pilot), count);
+        if (taken[slot] || std::find(candidate.begin(), candidate.end(), slot) != candidate.end())
+        {
+          break;
+        }
+        candidate.push_back(slot);
+      }
+      if (candidate.size() == last - first)
+      {
+        break;
+      }
+    }
+
+    pilots_[bucket] = static_cast<std::uint32_t>(pilot);
+    for (std::size_t i = first; i < last; i++)
+    {
+      slots[members[i]] = candidate[i - first];
+      taken[candidate[i - first]] = true;
+    }
+  }
+  return true;
+}
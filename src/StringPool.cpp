@@ -0,0 +1,191 @@
+#include "../include/StringPool.h"
+
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "../include/Hash.h"
+
+namespace
+{
+  const std::size_t INITIAL_INDEX_SIZE = 16;
+
+  std::uint32_t hashTag(std::uint64_t hash)
+  {
+    return static_cast<std::uint32_t>(hash >> 32);
+  }
+}
+
+
+StringPool::StringPool()
+  : arenaBytes_(0), cursor_(nullptr), remaining_(0),
+    slots_(INITIAL_INDEX_SIZE, Slot{ detail::NO_STRING_ID, 0 })
+{}
+
+StringPool::StringPool(StringPool&& other) noexcept
+  : blocks_(std::move(other.blocks_)), arenaBytes_(other.arenaBytes_), cursor_(other.cursor_),
+    remaining_(other.remaining_), strings_(std::move(other.strings_)), slots_(std::move(other.slots_))
+{
+  other.clear();
+}
+
+StringPool& StringPool::operator=(StringPool&& other) noexcept
+{
+  if (this != &other)
+  {
+    blocks_ = std::move(other.blocks_);
+    arenaBytes_ = other.arenaBytes_;
+    cursor_ = other.cursor_;
+    remaining_ = other.remaining_;
+    strings_ = std::move(other.strings_);
+    slots_ = std::move(other.slots_);
+    other.clear();
+  }
+  return *this;
+}
+
+// Returns the id of value, adding it first if the pool has not seen it.
+StringId StringPool::intern(std::string_view value)
+{
+  if (value.size() > UINT32_MAX)
+  {
+    throw std::length_error("String is too long for a string pool.");
+  }
+
+  std::uint64_t hash = detail::hashBytes(value.data(), value.size());
+  std::size_t index = findSlot(value, hash);
+  if (slots_[index].id != detail::NO_STRING_ID)
+  {
+    return slots_[index].id;
+  }
+  if (strings_.size() == detail::NO_STRING_ID)
+  {
+    throw std::length_error("String pool is out of ids.");
+  }
+
+  // Keep the index at most half full so probe sequences stay short.
+  if ((strings_.size() + 1) * 2 > slots_.size())
+  {
+    growIndex();
+    index = findSlot(value, hash);
+  }
+
+  StringId id = static_cast<StringId>(strings_.size());
+  strings_.push_back(store(value));
+  slots_[index] = Slot{ id, hashTag(hash) };
+  return id;
+}
+
+bool StringPool::find(std::string_view value, StringId& id) const
+{
+  const Slot& slot = slots_[findSlot(value, detail::hashBytes(value.data(), value.size()))];
+  if (slot.id == detail::NO_STRING_ID)
+  {
+    return false;
+  }
+  id = slot.id;
+  return true;
+}
+
+std::string_view StringPool::view(StringId id) const
+{
+  const char* entry = strings_[id];
+  std::uint32_t length;
+  std::memcpy(&length, entry, sizeof(length));
+  return std::string_view(entry + sizeof(length), length);
+}
+
+void StringPool::clear()
+{
+  blocks_.clear();
+  arenaBytes_ = 0;
+  cursor_ = nullptr;
+  remaining_ = 0;
+  strings_.clear();
+  slots_.assign(INITIAL_INDEX_SIZE, Slot{ detail::NO_STRING_ID, 0 });
+}
+
+std::size_t StringPool::size() const
+{
+  return strings_.size();
+}
+
+bool StringPool::empty() const
+{
+  return strings_.empty();
+}
+
+// Bytes held by the arena blocks and both indexes.
+std::size_t StringPool::memoryUsage() const
+{
+  return arenaBytes_ + strings_.capacity() * sizeof(const char*) + slots_.capacity() * sizeof(Slot)
+    + blocks_.capacity() * sizeof(std::unique_ptr<char[]>);
+}
+
+// Index of the slot holding value, or of the empty slot where it belongs.
+std::size_t StringPool::findSlot(std::string_view value, std::uint64_t hash) const
+{
+  std::size_t mask = slots_.size() - 1;
+  std::uint32_t tag = hashTag(hash);
+  for (std::size_t index = static_cast<std::size_t>(hash) & mask;; index = (index + 1) & mask)
+  {
+    const Slot& slot = slots_[index];
+    if (slot.id == detail::NO_STRING_ID || (slot.tag == tag && view(slot.id) == value))
+    {
+      return index;
+    }
+  }
+}
+
+// Copies value into the arena behind a 32-bit length. Strings too large to
+// share a block get one of their own.
+const char* StringPool::store(std::string_view value)
+{
+  std::uint32_t length = static_cast<std::uint32_t>(value.size());
+  std::size_t needed = sizeof(length) + value.size();
+  char* entry;
+  if (needed > detail::STRING_POOL_BLOCK_SIZE / 4)
+  {
+    blocks_.push_back(std::make_unique<char[]>(needed));
+    arenaBytes_ += needed;
+    entry = blocks_.back().get();
+  }
+  else
+  {
+    if (needed > remaining_)
+    {
+      blocks_.push_back(std::make_unique<char[]>(detail::STRING_POOL_BLOCK_SIZE));
+      arenaBytes_ += detail::STRING_POOL_BLOCK_SIZE;
+      cursor_ = blocks_.back().get();
+      remaining_ = detail::STRING_POOL_BLOCK_SIZE;
+    }
+    entry = cursor_;
+    cursor_ += needed;
+    remaining_ -= needed;
+  }
+
+  std::memcpy(entry, &length, sizeof(length));
+  std::memcpy(entry + sizeof(length), value.data(), value.size());
+  return entry;
+}
+
+void StringPool::growIndex()
+{
+  std::vector<Slot> slots(slots_.size() * 2, Slot{ detail::NO_STRING_ID, 0 });
+  std::size_t mask = slots.size() - 1;
+  for (const Slot& slot : slots_)
+  {
+    if (slot.id == detail::NO_STRING_ID)
+    {
+      continue;
+    }
+    std::string_view value = view(slot.id);
+    std::size_t index = static_cast<std::size_t>(detail::hashBytes(value.data(), value.size())) & mask;
+    while (slots[index].id != detail::NO_STRING_ID)
+    {
+      index = (index + 1) & mask;
+    }
+    slots[index] = slot;
+  }
+  slots_.swap(slots);
+}
@@ -0,0 +1,286 @@
+#include "../include/VersionedDictionary.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+  const unsigned HASH_BITS = std::numeric_limits<std::size_t>::digits;
+
+  // The entry for word in entries sorted by hash, or entries.end().
+  template <class Entries>
+  auto findEntry(Entries& entries, std::size_t hash, std::string_view word)
+  {
+    auto it = std::lower_bound(entries.begin(), entries.end(), hash,
+      [](const detail::VersionEntry& entry, std::size_t value) { return entry.hash < value; });
+    while (it != entries.end() && it->hash == hash)
+    {
+      if (it->word == word)
+      {
+        return it;
+      }
+      ++it;
+    }
+    return entries.end();
+  }
+}
+
+
+// Every slot starts out pointing at one empty segment of depth 0.
+DictionaryVersion::DictionaryVersion()
+  : segments_(std::size_t(1) << detail::VERSION_MIN_DEPTH, std::make_shared<detail::VersionSegment>()), size_(0),
+    depth_(detail::VERSION_MIN_DEPTH)
+{}
+
+const DictionaryVersion::TranslationList* DictionaryVersion::find(std::string_view word) const
+{
+  std::size_t hash = detail::StringHash{}(word);
+  const std::vector<detail::VersionEntry>& entries = segments_[segmentIndex(hash)]->entries;
+  auto it = findEntry(entries, hash, word);
+  return it != entries.end() ? &it->translations : nullptr;
+}
+
+bool DictionaryVersion::contains(std::string_view word) const
+{
+  return find(word) != nullptr;
+}
+
+std::size_t DictionaryVersion::size() const
+{
+  return size_;
+}
+
+bool DictionaryVersion::empty() const
+{
+  return size_ == 0;
+}
+
+std::size_t DictionaryVersion::segmentCount() const
+{
+  std::size_t count = 0;
+  forEachSegment([&count](const detail::VersionSegment&) { ++count; });
+  return count;
+}
+
+// Segments this version has in common with other, which is the memory the
+// two share.
+std::size_t DictionaryVersion::sharedSegments(const DictionaryVersion& other) const
+{
+  std::unordered_set<const detail::VersionSegment*> theirs;
+  other.forEachSegment([&theirs](const detail::VersionSegment& segment) { theirs.insert(&segment); });
+  std::size_t count = 0;
+  forEachSegment([&count, &theirs](const detail::VersionSegment& segment) { count += theirs.count(&segment); });
+  return count;
+}
+
+std::size_t DictionaryVersion::segmentIndex(std::size_t hash) const
+{
+  return hash >> (HASH_BITS - depth_);
+}
+
+
+DictionaryEditor::DictionaryEditor(std::shared_ptr<const DictionaryVersion> base)
+  : base_(base != nullptr ? std::move(base) : std::make_shared<const DictionaryVersion>())
+{}
+
+// Edits that change nothing, such as adding a translation the word already
+// has, are answered from the shared segment and copy nothing.
+void DictionaryEditor::insert(const std::string& word, const std::string& translation)
+{
+  const TranslationList* translations = version().find(word);
+  if (translations != nullptr && translations->contains(translation))
+  {
+    return;
+  }
+
+  DictionaryVersion& next = edit();
+  std::size_t hash = detail::StringHash{}(word);
+  if (translations == nullptr)
+  {
+    // A split can leave every word on one side, so split until there is room.
+    while (next.segments_[next.segmentIndex(hash)]->entries.size() >= detail::VERSION_SEGMENT_CAPACITY
+      && next.segments_[next.segmentIndex(hash)]->depth + 1 < HASH_BITS)
+    {
+      split(next.segmentIndex(hash));
+    }
+  }
+
+  std::vector<detail::VersionEntry>& entries = ownSegment(next.segmentIndex(hash)).entries;
+  auto it = findEntry(entries, hash, word);
+  if (it == entries.end())
+  {
+    it = std::upper_bound(entries.begin(), entries.end(), hash,
+      [](std::size_t value, const detail::VersionEntry& entry) { return value < entry.hash; });
+    it = entries.insert(it, detail::VersionEntry{ hash, word, TranslationList() });
+    ++next.size_;
+  }
+  it->translations.insert(translation);
+}
+
+void DictionaryEditor::remove(std::string_view word, std::string_view translation)
+{
+  const TranslationList* translations = version().find(word);
+  if (translations == nullptr || !translations->contains(translation))
+  {
+    return;
+  }
+
+  DictionaryVersion& next = edit();
+  std::size_t hash = detail::StringHash{}(word);
+  std::vector<detail::VersionEntry>& entries = ownSegment(next.segmentIndex(hash)).entries;
+  auto it = findEntry(entries, hash, word);
+  if (it->translations.remove(translation) && it->translations.empty())
+  {
+    entries.erase(it);
+    --next.size_;
+  }
+}
+
+bool DictionaryEditor::remove(std::string_view word)
+{
+  if (!version().contains(word))
+  {
+    return false;
+  }
+
+  DictionaryVersion& next = edit();
+  std::size_t hash = detail::StringHash{}(word);
+  std::vector<detail::VersionEntry>& entries = ownSegment(next.segmentIndex(hash)).entries;
+  entries.erase(findEntry(entries, hash, word));
+  --next.size_;
+  return true;
+}
+
+void DictionaryEditor::clear()
+{
+  next_ = std::make_shared<DictionaryVersion>();
+  owned_.clear();
+}
+
+// The version being built, including edits not committed yet.
+const DictionaryVersion& DictionaryEditor::version() const
+{
+  return next_ != nullptr ? *next_ : *base_;
+}
+
+// Freezes the edits made so far into a version that is never modified again;
+// later edits start the next one from it.
+std::shared_ptr<const DictionaryVersion> DictionaryEditor::commit()
+{
+  if (next_ != nullptr)
+  {
+    base_ = std::move(next_);
+    next_ = nullptr;
+    owned_.clear();
+  }
+  return base_;
+}
+
+// Copies the directory of the base on the first edit after a commit; the
+// segments themselves stay shared until ownSegment().
+DictionaryVersion& DictionaryEditor::edit()
+{
+  if (next_ == nullptr)
+  {
+    next_ = std::make_shared<DictionaryVersion>(*base_);
+    owned_.clear();
+  }
+  return *next_;
+}
+
+detail::VersionSegment& DictionaryEditor::ownSegment(std::size_t index)
+{
+  std::shared_ptr<detail::VersionSegment> segment = next_->segments_[index];
+  if (owned_.count(segment.get()) == 0)
+  {
+    segment = std::make_shared<detail::VersionSegment>(*segment);
+    owned_.insert(segment.get());
+    pointSlots(index, segment->depth, segment);
+  }
+  return *segment;
+}
+
+// Splits the segment at index in two on the next hash bit, doubling the
+// directory first if the segment already uses all of its bits. Doubling
+// copies slot pointers only; the other segments stay shared with the base.
+void DictionaryEditor::split(std::size_t index)
+{
+  DictionaryVersion& next = *next_;
+  std::shared_ptr<detail::VersionSegment> segment = next.segments_[index];
+  if (segment->depth == next.depth_)
+  {
+    std::vector<std::shared_ptr<detail::VersionSegment>> segments;
+    segments.reserve(next.segments_.size() * 2);
+    for (const std::shared_ptr<detail::VersionSegment>& slot : next.segments_)
+    {
+      segments.push_back(slot);
+      segments.push_back(slot);
+    }
+    next.segments_.swap(segments);
+    ++next.depth_;
+    index <<= 1;
+  }
+
+  unsigned depth = segment->depth + 1;
+  std::size_t splitBit = std::size_t(1) << (HASH_BITS - depth);
+  std::vector<detail::VersionEntry>& entries = segment->entries;
+  auto middle = std::partition_point(entries.begin(), entries.end(),
+    [splitBit](const detail::VersionEntry& entry) { return (entry.hash & splitBit) == 0; });
+
+  auto low = std::make_shared<detail::VersionSegment>();
+  auto high = std::make_shared<detail::VersionSegment>();
+  low->depth = depth;
+  high->depth = depth;
+  if (owned_.erase(segment.get()) != 0)
+  {
+    low->entries.assign(std::make_move_iterator(entries.begin()), std::make_move_iterator(middle));
+    high->entries.assign(std::make_move_iterator(middle), std::make_move_iterator(entries.end()));
+  }
+  else
+  {
+    low->entries.assign(entries.begin(), middle);
+    high->entries.assign(middle, entries.end());
+  }
+  owned_.insert(low.get());
+  owned_.insert(high.get());
+
+  std::size_t lowIndex = index & ~((std::size_t(1) << (next.depth_ - depth + 1)) - 1);
+  pointSlots(lowIndex, depth, low);
+  pointSlots(lowIndex + (std::size_t(1) << (next.depth_ - depth)), depth, high);
+}
+
+// Points every slot of the depth-deep segment range holding index at segment.
+void DictionaryEditor::pointSlots(std::size_t index, unsigned depth,
+  const std::shared_ptr<detail::VersionSegment>& segment)
+{
+  std::size_t span = std::size_t(1) << (next_->depth_ - depth);
+  auto first = next_->segments_.begin() + static_cast<std::ptrdiff_t>(index & ~(span - 1));
+  std::fill(first, first + static_cast<std::ptrdiff_t>(span), segment);
+}
+
+VersionedDictionary::VersionedDictionary() : current_(std::make_shared<const DictionaryVersion>())
+{}
+
+std::shared_ptr<const DictionaryVersion> VersionedDictionary::snapshot() const
+{
+  return std::atomic_load(&current_);
+}
+
+// An editor starting from the current version. Publishing its result drops
+// anything published in between.
+DictionaryEditor VersionedDictionary::edit() const
+{
+  return DictionaryEditor(snapshot());
+}
+
+void VersionedDictionary::publish(std::shared_ptr<const DictionaryVersion> version)
+{
+  if (version == nullptr)
+  {
+    throw std::invalid_argument("Cannot publish an empty version.");
+  }
+  std::atomic_store(&current_, std::move(version));
+}
@@ -0,0 +1,1713 @@
+﻿#undef NDEBUG
+#include <cassert>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "../include/ConcurrentHashMap.h"
+#include "../include/Dictionary.h"
+#include "../include/DictionaryParser.h"
+#include "../include/DictionarySnapshot.h"
+#include "../include/FlatHashMap.h"
+#include "../include/InternedDictionary.h"
+#include "../include/LinkedList.h"
+#include "../include/PoolAllocator.h"
+#include "../include/ReadMostlyHashMap.h"
+#include "../include/SmallSortedSet.h"
+#include "../include/StaticDictionary.h"
+#include "../include/VersionedDictionary.h"
+#include "staticTestWords.h"
+
+
+// Key that counts how often it is built from a string_view or copied.
+struct CountedKey
+{
+  static inline int conversions = 0;
+  static inline int copies = 0;
+
+  explicit CountedKey(std::string_view text) : value(text) { ++conversions; }
+  CountedKey(const CountedKey& other) : value(other.value) { ++copies; }
+  CountedKey(CountedKey&& other) = default;
+
+  std::string value;
+};
+
+bool operator==(const CountedKey& lhs, const CountedKey& rhs)
+{
+  return lhs.value == rhs.value;
+}
+
+bool operator==(const CountedKey& lhs, std::string_view rhs)
+{
+  return lhs.value == rhs;
+}
+
+struct CountedKeyHash
+{
+  using is_transparent = void;
+
+  std::size_t operator()(std::string_view key) const { return detail::StringHash{}(key); }
+  std::size_t operator()(const CountedKey& key) const { return detail::StringHash{}(key.value); }
+};
+
+// Key that counts how often it is compared.
+struct ComparedKey
+{
+  static inline std::atomic<int> comparisons{ 0 };
+
+  int value;
+};
+
+bool operator==(const ComparedKey& lhs, const ComparedKey& rhs)
+{
+  ++ComparedKey::comparisons;
+  return lhs.value == rhs.value;
+}
+
+struct ComparedKeyHash
+{
+  std::size_t operator()(const ComparedKey& key) const { return std::hash<int>{}(key.value); }
+};
+
+// Sends every key to the same probe run.
+struct CollidingHash
+{
+  std::size_t operator()(const ComparedKey&) const { return 0; }
+};
+
+// Allocator that notes, for every bucket array given back, how many old
+// buckets per operation its migration moved: the array's size over the
+// operations since the array that replaced it was allocated.
+struct MigrationPace
+{
+  static inline std::size_t operations = 0;
+  static inline std::size_t lastArray = 0;
+  static inline std::size_t worstBucketsPerOperation = 0;
+};
+
+template <class T>
+struct PacedAllocator
+{
+  using value_type = T;
+
+  PacedAllocator() = default;
+  template <class U>
+  PacedAllocator(const PacedAllocator<U>&) {}
+
+  T* allocate(std::size_t count)
+  {
+    if (count > 1)
+    {
+      MigrationPace::lastArray = MigrationPace::operations;
+    }
+    return std::allocator<T>().allocate(count);
+  }
+
+  void deallocate(T* pointer, std::size_t count)
+  {
+    if (count > 1)
+    {
+      std::size_t operations = std::max<std::size_t>(1, MigrationPace::operations - MigrationPace::lastArray);
+      MigrationPace::worstBucketsPerOperation = std::max(MigrationPace::worstBucketsPerOperation, count / operations);
+    }
+    std::allocator<T>().deallocate(pointer, count);
+  }
+
+  bool operator==(const PacedAllocator&) const { return true; }
+  bool operator!=(const PacedAllocator&) const { return false; }
+};
+
+template <class DictionaryType>
+void testDictionary()
+{
+  DictionaryType dict;
+
+  // Test 1: Insert elements
+  dict.insert("hello", "привет");
+  dict.insert("world", "мир");
+  dict.insert("world", "земля");
+
+  assert(dict.size() == 2);
+  assert(dict.find("hello") != dict.end());
+  assert(dict.find("world")->second.size() == 2);
+
+  // Test 2: Remove specific translation
+  dict.remove("world", "земля");
+  auto translations = dict.find("world");
+  assert(translations->second.size() == 1);
+
+  // Test 3: Remove key entirely
+  dict.remove("hello", "привет");
+  assert(dict.find("hello") == dict.end());
+
+  // Test 4: Handle non-existing keys
+  dict.remove("nonexistent", "value");
+  assert(dict.size() == 1);
+
+  // Test 5: Load factor
+  dict.insert("key1", "value1");
+  dict.insert("key2", "value2");
+  assert(dict.loadFactor() > 0 && dict.loadFactor() <= 1);
+
+  // Test 6: Clear dictionary
+  dict.clear();
+  assert(dict.empty());
+
+  // Test 7: Re-insertion after clearing
+  dict.insert("test", "тест");
+  assert(dict.size() == 1);
+
+  // Test 8: Handling duplicate insertions
+  dict.insert("test", "тест");
+  dict.insert("test", "пример");
+  translations = dict.find("test");
+  assert(translations->second.size() == 2);
+
+  // Test 9: Edge cases for empty dictionary
+  dict.clear();
+  assert(dict.empty());
+  assert(dict.find("nonexistent") == dict.end());
+
+  std::cout << "All Dictionary tests completed successfully.\n";
+}
+
+void testFlatHashMap()
+{
+  HashMap<int, int, std::hash<int>, detail::FlatStorage> map;
+
+  // Test 1: Insert enough elements to force several rehashes
+  for (int i = 0; i < 1000; i++)
+  {
+    map.insert(i, i * i);
+  }
+  assert(map.size() == 1000);
+  assert(map.find(31)->second == 961);
+  assert(map.find(1000) == map.end());
+
+  // Test 2: Overwrite an existing key
+  map.insert(31, -1);
+  assert(map.size() == 1000);
+  assert(map.find(31)->second == -1);
+
+  // Test 3: Remove every even key and make sure probing still reaches the odd ones
+  for (int i = 0; i < 1000; i += 2)
+  {
+    assert(map.remove(i));
+  }
+  assert(!map.remove(0));
+  assert(map.size() == 500);
+  for (int i = 0; i < 1000; i++)
+  {
+    assert((map.find(i) != map.end()) == (i % 2 == 1));
+  }
+
+  // Test 4: Iteration visits every live slot exactly once
+  std::size_t count = 0;
+  for (auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    assert(it->first % 2 == 1);
+    ++count;
+  }
+  assert(count == map.size());
+
+  // Test 5: Reuse of deleted slots and clearing
+  for (int i = 0; i < 1000; i += 2)
+  {
+    map.insert(i, i);
+  }
+  assert(map.size() == 1000);
+  map.clear();
+  assert(map.empty());
+  assert(map.begin() == map.end());
+
+  // Test 6: Random churn keeps control bytes and tombstones consistent
+  std::vector<bool> present(4096, false);
+  unsigned int seed = 12345;
+  for (int i = 0; i < 200000; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    int key = static_cast<int>((seed >> 8) % present.size());
+    if (present[key])
+    {
+      assert(map.remove(key));
+    }
+    else
+    {
+      map.insert(key, key);
+    }
+    present[key] = !present[key];
+  }
+  for (int key = 0; key < static_cast<int>(present.size()); key++)
+  {
+    assert((map.find(key) != map.end()) == present[key]);
+  }
+
+  // Test 7: Growing and shrinking the slot array move keys
+  HashMap<CountedKey, int, CountedKeyHash, detail::FlatStorage> counted;
+  CountedKey::copies = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    counted.emplace(std::to_string(i), i);
+  }
+  for (int i = 10; i < 1000; i++)
+  {
+    assert(counted.remove(std::string_view(std::to_string(i))));
+  }
+  counted.shrinkToFit();
+  assert(counted.size() == 10 && counted.find(std::string_view("9"))->second == 9);
+  assert(CountedKey::copies == 0);
+
+  std::cout << "All FlatHashMap tests passed successfully.\n";
+}
+
+void testDenseHashMap()
+{
+  HashMap<int, int, std::hash<int>, detail::DenseStorage> map;
+
+  // Test 1: Entries are packed in insertion order across several rehashes
+  for (int i = 0; i < 1000; i++)
+  {
+    map.insert(i, i * i);
+  }
+  assert(map.size() == 1000 && map.end() - map.begin() == 1000);
+  for (int i = 0; i < 1000; i++)
+  {
+    assert(map.begin()[i].first == i);
+  }
+  assert(map.find(31)->second == 961);
+  assert(map.find(1000) == map.end());
+
+  // Test 2: Removing moves the last entry into the gap
+  assert(map.remove(10));
+  assert(!map.remove(10));
+  assert(map.begin()[10].first == 999 && map.find(999) == map.begin() + 10);
+  assert(map.cend() - map.cbegin() == 999);
+
+  // Test 3: After a mass removal iteration only visits what is left
+  for (int i = 0; i < 1000; i++)
+  {
+    if (i % 100 != 0)
+    {
+      map.remove(i);
+    }
+  }
+  assert(map.size() == 10);
+  int sum = 0;
+  for (auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    assert(it->first % 100 == 0);
+    sum += it->first;
+  }
+  assert(sum == 4500);
+
+  // Test 4: Random churn keeps the index and the packed entries consistent
+  map.clear();
+  assert(map.empty() && map.begin() == map.end());
+  std::vector<bool> present(4096, false);
+  unsigned int seed = 12345;
+  for (int i = 0; i < 200000; i++)
+  {
+    seed = seed * 1103515245 + 12345;
+    int key = static_cast<int>((seed >> 8) % present.size());
+    if (present[key])
+    {
+      assert(map.remove(key));
+    }
+    else
+    {
+      map.insert(key, key);
+    }
+    present[key] = !present[key];
+  }
+  for (int key = 0; key < static_cast<int>(present.size()); key++)
+  {
+    auto found = map.find(key);
+    assert((found != map.end()) == present[key]);
+    assert(found == map.end() || found->second == key);
+  }
+  assert(static_cast<std::size_t>(std::count(present.begin(), present.end(), true)) == map.size());
+
+  // Test 5: Growing the entry array and filling a removal gap move keys
+  HashMap<CountedKey, int, CountedKeyHash, detail::DenseStorage> counted;
+  CountedKey::copies = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    counted.emplace(std::to_string(i), i);
+  }
+  for (int i = 0; i < 1000; i += 2)
+  {
+    assert(counted.remove(std::string_view(std::to_string(i))));
+  }
+  assert(counted.size() == 500 && counted.find(std::string_view("999"))->second == 999);
+  assert(CountedKey::copies == 0);
+
+  // Test 6: An insert compares keys during one probe only, rehash or not
+  HashMap<ComparedKey, int, CollidingHash, detail::DenseStorage> colliding;
+  ComparedKey::comparisons = 0;
+  for (int i = 0; i < 200; i++)
+  {
+    assert(colliding.tryEmplace(ComparedKey{ i }, i).second);
+  }
+  assert(ComparedKey::comparisons == 200 * 199 / 2);
+
+  std::cout << "All DenseHashMap tests passed successfully.\n";
+}
+
+void testIncrementalRehash()
+{
+  HashMap<int, int> map;
+  map.setIncrementalRehash(true);
+
+  // Test 1: Every key stays reachable while buckets migrate between tables
+  for (int i = 0; i < 5000; i++)
+  {
+    map.insert(i, i);
+    assert(map.find(i / 2)->second == i / 2);
+  }
+  assert(map.size() == 5000);
+
+  // Test 2: Iteration covers both bucket arrays exactly once
+  std::size_t count = 0;
+  long long sum = 0;
+  for (auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    sum += it->first;
+    ++count;
+  }
+  assert(count == 5000);
+  assert(sum == 4999LL * 5000 / 2);
+
+  // Test 3: Remove and overwrite keys that may still live in the old table
+  for (int i = 0; i < 5000; i += 3)
+  {
+    assert(map.remove(i));
+  }
+  map.insert(1, -1);
+  assert(map.find(1)->second == -1);
+  assert(map.find(3) == map.end());
+  assert(map.size() == 5000 - 1667);
+
+  // Test 4: Lookups made while iterating mid-rehash do not move buckets
+  // under the iterator
+  HashMap<int, int> growing;
+  growing.setIncrementalRehash(true);
+  int key = 0;
+  float lastLoadFactor = 0;
+  while (growing.loadFactor() >= lastLoadFactor)
+  {
+    lastLoadFactor = growing.loadFactor();
+    growing.insert(key++, 0);
+  }
+  auto position = growing.cbegin();
+  ++position;
+  for (int round = 0; round < 100; round++)
+  {
+    for (int i = 0; i < key; i++)
+    {
+      assert(growing.find(i) != growing.end());
+      assert(!growing.tryEmplace(i, 1).second);
+    }
+  }
+  std::size_t seen = 1;
+  for (; position != growing.cend(); ++position)
+  {
+    ++seen;
+  }
+  assert(seen == growing.size());
+
+  // Test 5: A migration ends before the table has to grow again, even right
+  // after a shrink to just under the maximum load
+  {
+    HashMap<int, int, std::hash<int>, detail::ChainedStorage, PacedAllocator<detail::Pair<const int, int>>> paced;
+    paced.setIncrementalRehash(true);
+    paced.setMaxLoadFactor(1.0f);
+    paced.setMinLoadFactor(0.5f);
+    for (int round = 0; round < 3; round++)
+    {
+      for (int i = 0; i < 4000; i++, MigrationPace::operations++)
+      {
+        paced.insert(i, i);
+      }
+      for (int i = 100; i < 4000; i++, MigrationPace::operations++)
+      {
+        assert(paced.remove(i));
+      }
+    }
+    assert(paced.size() == 100 && MigrationPace::worstBucketsPerOperation <= 16);
+  }
+
+  // Test 6: Switching back to synchronous mode completes the pending migration
+  map.setIncrementalRehash(false);
+  map.rehash(1 << 14);
+  assert(map.find(4999)->second == 4999);
+
+  // Test 7: Rehashing relinks the existing nodes instead of copying them
+  const int* value = &map.find(4999)->second;
+  map.rehash(1 << 15);
+  assert(&map.find(4999)->second == value);
+
+  map.clear();
+  assert(map.empty());
+  assert(map.begin() == map.end());
+
+  std::cout << "All incremental rehash tests passed successfully.\n";
+}
+
+void testPoolAllocator()
+{
+  using PoolMap = HashMap<int, SortedUniqueList<int, PoolAllocator<int>>, std::hash<int>,
+    detail::ChainedStorage, PoolAllocator<detail::Pair<const int, SortedUniqueList<int, PoolAllocator<int>>>>>;
+  PoolMap map;
+
+  // Test 1: Map nodes and the lists stored in them share one pool
+  for (int i = 0; i < 2000; i++)
+  {
+    SortedUniqueList<int, PoolAllocator<int>> lst(map.getAllocator());
+    lst.insert(i);
+    lst.insert(-i);
+    map.insert(i, lst);
+  }
+  assert(map.size() == 2000);
+  assert(map.find(7)->second.size() == 2);
+  assert(map.find(7)->second.getAllocator() == map.getAllocator());
+
+  // Test 2: Freed nodes are recycled and the pool survives a full clear
+  for (int i = 0; i < 2000; i += 2)
+  {
+    assert(map.remove(i));
+  }
+  map.clear();
+  assert(map.empty());
+  map.insert(1, SortedUniqueList<int, PoolAllocator<int>>(map.getAllocator()));
+  assert(map.find(1)->second.empty());
+
+  // Test 3: Lists moved between pools keep freeing nodes into the right pool
+  SortedUniqueList<int, PoolAllocator<int>> first;
+  SortedUniqueList<int, PoolAllocator<int>> second;
+  first.insert(1);
+  second.insert(2);
+  first = second;
+  second = std::move(first);
+  assert(second.size() == 1 && second.front() == 2);
+
+  // Test 4: Buckets are a bare head pointer, with no copy of the pool handle
+  static_assert(sizeof(PoolMap::BucketType) == sizeof(void*), "bucket carries allocator state");
+  static_assert(sizeof(PooledDictionary::BucketType) == sizeof(Dictionary::BucketType), "bucket carries allocator state");
+
+  std::cout << "All PoolAllocator tests passed successfully.\n";
+}
+
+template <class Storage>
+void testEmplace()
+{
+  using MoveOnlyMap = HashMap<std::string, std::unique_ptr<int>, detail::StringHash, Storage>;
+  MoveOnlyMap map;
+
+  // Test 1: Move-only values are constructed in place
+  auto result = map.emplace("one", std::make_unique<int>(1));
+  assert(result.second && *result.first->second == 1);
+  assert(!map.emplace("one", std::make_unique<int>(2)).second);
+  assert(*map.find("one")->second == 1);
+
+  // Test 2: tryEmplace leaves its arguments untouched when the key exists
+  std::unique_ptr<int> two = std::make_unique<int>(2);
+  assert(!map.tryEmplace("one", std::move(two)).second);
+  assert(two != nullptr);
+  assert(map.tryEmplace("two", std::move(two)).second);
+  assert(two == nullptr);
+
+  // Test 3: insertOrAssign and rvalue insert
+  assert(!map.insertOrAssign("one", std::make_unique<int>(3)).second);
+  assert(*map.find("one")->second == 3);
+  map.insert(std::string("four"), std::make_unique<int>(4));
+  assert(map.size() == 3);
+
+  // Test 4: Moving the whole map
+  MoveOnlyMap moved(std::move(map));
+  assert(moved.size() == 3 && *moved.find("four")->second == 4);
+  assert(map.empty());
+  map.emplace("five", std::make_unique<int>(5));
+  map = std::move(moved);
+  assert(map.size() == 3 && map.find("five") == map.end());
+
+  // Test 5: The returned iterator stays valid across the growth it triggers
+  for (int i = 0; i < 100; ++i)
+  {
+    std::string key = "key" + std::to_string(i);
+    auto inserted = map.tryEmplace(key, std::make_unique<int>(i));
+    assert(inserted.second && inserted.first->first == key && *inserted.first->second == i);
+  }
+  assert(map.size() == 103);
+
+  // Test 6: With a transparent hash, emplacing a key that is already there
+  // by string_view builds no Key
+  HashMap<CountedKey, int, CountedKeyHash, Storage> counted;
+  std::string_view word = "word";
+  assert(counted.emplace(word, 1).second);
+  int conversions = CountedKey::conversions;
+  assert(!counted.emplace(word, 2).second && counted.find(word)->second == 1);
+  assert(CountedKey::conversions == conversions);
+
+  std::cout << "All emplace tests passed successfully.\n";
+}
+
+template <class Storage, bool INCREMENTAL = false>
+void testShrink()
+{
+  HashMap<int, int, std::hash<int>, Storage> map;
+  if constexpr (INCREMENTAL)
+  {
+    map.setIncrementalRehash(true);
+  }
+
+  // Test 1: reserve sizes the table once for the whole load
+  map.reserve(1000);
+  map.insert(0, 0);
+  const int* first = &map.find(0)->second;
+  for (int i = 1; i < 1000; i++)
+  {
+    map.insert(i, i);
+  }
+  assert(&map.find(0)->second == first);
+  assert(map.loadFactor() > detail::DEFAULT_MAX_LOAD_FACTOR / 2 && map.loadFactor() <= detail::DEFAULT_MAX_LOAD_FACTOR);
+
+  // Test 2: Without a minimum load factor removal never shrinks, shrinkToFit does
+  for (int i = 10; i < 1000; i++)
+  {
+    assert(map.remove(i));
+  }
+  assert(map.loadFactor() < 0.01f);
+  map.shrinkToFit();
+  assert(map.loadFactor() > 0.5f);
+  for (int i = 0; i < 20; i++)
+  {
+    assert((map.find(i) != map.end()) == (i < 10));
+  }
+
+  // Test 3: Removal keeps the table above the minimum load factor
+  map.setMinLoadFactor(0.25f);
+  for (int i = 10; i < 5000; i++)
+  {
+    map.insert(i, i);
+  }
+  for (int i = 4999; i >= 5; i--)
+  {
+    assert(map.remove(i));
+    assert(INCREMENTAL || map.loadFactor() >= 0.25f || map.size() < 2);
+  }
+  if constexpr (INCREMENTAL)
+  {
+    // A shrink still moving entries defers the next one; lookups leave it
+    // alone, inserts and removals finish it
+    for (int i = 0; i < 5000; i++)
+    {
+      map.insert(5000, 0);
+      map.remove(5000);
+    }
+    map.remove(4);
+    assert(map.loadFactor() >= 0.25f);
+    map.insert(4, 4);
+  }
+  for (int i = 0; i < 5000; i++)
+  {
+    auto found = map.find(i);
+    assert((found != map.end()) == (i < 5));
+    assert(found == map.end() || found->second == i);
+  }
+
+  // Test 4: clear() gives the bucket array back too
+  for (int i = 0; i < 5000; i++)
+  {
+    map.insert(i, i);
+  }
+  map.clear();
+  map.insert(1, 1);
+  assert(map.loadFactor() >= 1.0f / detail::MIN_BUCKET_COUNT && map.find(1)->second == 1);
+
+  // Test 5: The two limits must stay a factor of two apart
+  bool rejected = false;
+  try
+  {
+    map.setMinLoadFactor(0.5f);
+  }
+  catch (const std::invalid_argument&)
+  {
+    rejected = true;
+  }
+  assert(rejected);
+  rejected = false;
+  try
+  {
+    map.setMaxLoadFactor(0.4f);
+  }
+  catch (const std::invalid_argument&)
+  {
+    rejected = true;
+  }
+  assert(rejected);
+
+  std::cout << "All shrink tests passed successfully.\n";
+}
+
+void testSortedUniqueList()
+{
+  SortedUniqueList<int> list;
+
+  // Test 1: Insert elements
+  assert(list.insert(5));   // OK
+  assert(list.insert(3));   // OK
+  assert(list.insert(8));   // OK
+  assert(!list.insert(5));  // duplicate!
+
+  auto it = list.cbegin();
+  assert(*it++ == 3);
+  assert(*it++ == 5);
+  assert(*it++ == 8);
+  assert(it == list.cend());
+
+  // Test 2: Remove an element
+  assert(list.remove(5));
+  assert(!list.remove(5));
+
+  it = list.cbegin();
+  assert(*it++ == 3);
+  assert(*it++ == 8);
+  assert(it == list.cend());
+
+  // Test 3: Check empty and size
+  assert(!list.empty());
+  assert(list.size() == 2);
+
+  // Test 4: Clear the list
+  list.clear();
+  assert(list.empty());
+  assert(list.size() == 0);
+
+  // Test 5: Insert after clearing
+  assert(list.insert(10));
+  assert(list.insert(1));
+  assert(list.insert(5));
+
+  it = list.cbegin();
+  assert(*it++ == 1);
+  assert(*it++ == 5);
+  assert(*it++ == 10);
+  assert(it == list.cend());
+
+  // Test 6: Handling negative and duplicate values
+  assert(list.insert(-1));
+  assert(!list.insert(-1));
+
+  it = list.cbegin();
+  assert(*it++ == -1);
+  assert(*it++ == 1);
+  assert(*it++ == 5);
+  assert(*it++ == 10);
+  assert(it == list.cend());
+
+  std::cout << "All SortedUniqueList tests passed successfully.\n";
+}
+
+void testStringHash()
+{
+  detail::StringHash hash;
+
+  // Test 1: Equal keys hash equally, whatever their length
+  for (std::size_t length = 0; length <= 300; ++length)
+  {
+    std::string key(length, 'x');
+    assert(hash(key) == hash(std::string(key)));
+  }
+
+  // Test 2: Every input byte affects the result
+  std::string base(100, 'a');
+  for (std::size_t i = 0; i < base.size(); ++i)
+  {
+    std::string changed = base;
+    changed[i] = 'b';
+    assert(hash(changed) != hash(base));
+  }
+  assert(hash("") != hash(std::string(1, '\0')));
+
+  // Test 3: Similar keys spread over the low bits used as a bucket index
+  const std::size_t buckets = 64;
+  std::vector<std::size_t> counts(buckets, 0);
+  for (int i = 0; i < 6400; ++i)
+  {
+    ++counts[hash("key" + std::to_string(i)) & (buckets - 1)];
+  }
+  for (std::size_t count : counts)
+  {
+    assert(count > 50 && count < 150);
+  }
+
+  std::cout << "All StringHash tests passed successfully.\n";
+}
+
+struct CountingHash
+{
+  static inline std::size_t calls = 0;
+
+  std::size_t operator()(const std::string& key) const
+  {
+    ++calls;
+    return detail::StringHash{}(key);
+  }
+};
+
+void testCachedHash()
+{
+  HashMap<std::string, int, CountingHash> map;
+
+  // Test 1: Each insert hashes its key exactly once
+  for (int i = 0; i < 1000; i++)
+  {
+    map.insert(std::to_string(i), i);
+  }
+  assert(CountingHash::calls == 1000);
+
+  // Test 2: Growing the table reuses the stored hashes, both at once and
+  // incrementally
+  map.rehash(1 << 14);
+  map.setIncrementalRehash(true);
+  map.rehash(1 << 15);
+  for (int i = 1000; i < 30000; i++)
+  {
+    map.insert(std::to_string(i), i);
+  }
+  assert(CountingHash::calls == 30000);
+
+  // Test 3: Lookups and removals still resolve the right entries
+  assert(map.find("12345")->second == 12345);
+  assert(map.remove("12345"));
+  assert(map.find("12345") == map.end());
+  assert(map.size() == 29999);
+
+  // Test 4: A chain step reads the link and the hash from the key's cache
+  // line, however large the value
+  Dictionary::NodeType node(std::in_place, nullptr, std::size_t(0), std::string("key"), Dictionary::TranslationList());
+  const char* base = reinterpret_cast<const char*>(&node);
+  assert(reinterpret_cast<const char*>(&node.next) == base);
+  assert(reinterpret_cast<const char*>(&node.data.hash) - base == sizeof(void*));
+  assert(reinterpret_cast<const char*>(&node.data.first) - base == sizeof(void*) + sizeof(std::size_t));
+
+  std::cout << "All cached hash tests passed successfully.\n";
+}
+
+template <class Storage>
+void testConcurrentHashMap()
+{
+  const int threadCount = 8;
+  const int keysPerThread = 20000;
+  ConcurrentHashMap<int, int, std::hash<int>, Storage> map(8);
+
+  // Test 1: Writers on disjoint key ranges, with readers probing everything
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([&map, t, keysPerThread]()
+    {
+      int first = t * keysPerThread;
+      for (int i = first; i < first + keysPerThread; i++)
+      {
+        map.insert(i, i);
+        int value = -1;
+        assert(map.find(i, value) && value == i);
+        map.contains(i * 7 % (threadCount * keysPerThread));
+      }
+      for (int i = first + 1; i < first + keysPerThread; i += 2)
+      {
+        assert(map.remove(i));
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  assert(map.size() == threadCount * keysPerThread / 2);
+  for (int i = 0; i < threadCount * keysPerThread; i++)
+  {
+    assert(map.contains(i) == (i % 2 == 0));
+  }
+
+  // Test 2: Read-modify-write on shared keys is atomic per key
+  threads.clear();
+  map.clear();
+  for (int t = 0; t < threadCount; t++)
+  {
+    threads.emplace_back([&map]()
+    {
+      for (int i = 0; i < 10000; i++)
+      {
+        map.updateOrEmplace(i % 16, [](int& value) { ++value; }, 0);
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+  {
+    thread.join();
+  }
+
+  long long total = 0;
+  map.forEach([&total](int, int value) { total += value; });
+  assert(map.size() == 16 && total == threadCount * 10000);
+
+  // Test 3: Keys of one shard still differ in every tag bit, so a miss
+  // rarely compares keys
+  ConcurrentHashMap<ComparedKey, int, ComparedKeyHash, Storage> compared(16);
+  for (int i = 0; i < 20000; i++)
+  {
+    compared.insert(ComparedKey{ i }, i);
+  }
+  ComparedKey::comparisons = 0;
+  for (int i = 20000; i < 40000; i++)
+  {
+    assert(!compared.contains(ComparedKey{ i }));
+  }
+  assert(ComparedKey::comparisons < 20000 / 4);
+
+  std::cout << "All ConcurrentHashMap tests passed successfully.\n";
+}
+
+void testReadMostlyHashMap()
+{
+  ReadMostlyHashMap<int, std::shared_ptr<int>> map;
+
+  // Test 1: Basic operations and iteration
+  for (int i = 0; i < 1000; i++)
+  {
+    assert(map.tryEmplace(i, std::make_shared<int>(i)));
+  }
+  assert(!map.tryEmplace(0, nullptr));
+  assert(!map.insertOrAssign(1, std::make_shared<int>(-1)));
+  std::shared_ptr<int> value;
+  assert(map.find(1, value) && *value == -1);
+  assert(map.remove(2) && !map.remove(2) && !map.contains(2));
+  assert(map.size() == 999);
+
+  std::size_t count = 0;
+  for (auto it = map.cbegin(); it != map.cend(); ++it)
+  {
+    ++count;
+  }
+  assert(count == 999);
+
+  // Test 2: Removed entries stay alive while any thread is pinned
+  std::weak_ptr<int> removed = value;
+  value.reset();
+  {
+    auto it = map.cbegin();
+    map.remove(1);
+    detail::EpochDomain::instance().collect();
+    assert(!removed.expired());
+  }
+  detail::EpochDomain::instance().collect();
+  assert(removed.expired());
+
+  // Test 3: Readers run without locks against a writer that rewrites,
+  // removes and resizes
+  map.clear();
+  const int keyCount = 2000;
+  for (int i = 0; i < keyCount; i++)
+  {
+    map.insert(i, std::make_shared<int>(i));
+  }
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++)
+  {
+    readers.emplace_back([&map, &done, keyCount]()
+    {
+      while (!done.load())
+      {
+        for (int i = 0; i < keyCount; i += 7)
+        {
+          map.visit(i, [i](const std::shared_ptr<int>& found) { assert(*found == i || *found == -i); });
+        }
+        for (auto it = map.cbegin(); it != map.cend(); ++it)
+        {
+          assert(*it->second == it->first || *it->second == -it->first);
+        }
+      }
+    });
+  }
+
+  for (int round = 0; round < 20; round++)
+  {
+    for (int i = 0; i < keyCount; i++)
+    {
+      if (i % 3 == 0)
+      {
+        map.remove(i);
+        map.insert(i, std::make_shared<int>(i));
+      }
+      else
+      {
+        map.insertOrAssign(i, std::make_shared<int>(round % 2 == 0 ? -i : i));
+      }
+    }
+    map.rehash(keyCount << (round % 4));
+  }
+  done.store(true);
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+  assert(map.size() == keyCount);
+
+  std::cout << "All ReadMostlyHashMap tests passed successfully.\n";
+}
+
+template <class DictionaryType>
+void testBulkLoad()
+{
+  std::vector<std::pair<std::string, std::string>> entries;
+  for (int i = 0; i < 50000; i++)
+  {
+    entries.emplace_back("word" + std::to_string(i % 20000), "t" + std::to_string(i % 7));
+  }
+
+  // Test 1: Bulk load matches inserting the same pairs one by one
+  DictionaryType loaded;
+  loaded.insert("word1", "existing");
+  loaded.bulkLoad(entries.begin(), entries.end());
+
+  DictionaryType expected;
+  expected.insert("word1", "existing");
+  for (const auto& entry : entries)
+  {
+    expected.insert(entry.first, entry.second);
+  }
+
+  assert(loaded.size() == expected.size() && loaded.size() == 20000);
+  for (auto it = expected.begin(); it != expected.end(); ++it)
+  {
+    auto found = loaded.find(it->first);
+    assert(found != loaded.end() && found->second.size() == it->second.size());
+    for (auto lhs = found->second.begin(), rhs = it->second.begin(); rhs != it->second.end(); ++lhs, ++rhs)
+    {
+      assert(*lhs == *rhs);
+    }
+  }
+
+  // Test 2: Without a merge function the last value for a key wins
+  HashMap<int, int, std::hash<int>, typename DictionaryType::StorageType> map;
+  std::vector<std::pair<int, int>> pairs;
+  for (int i = 0; i < 30000; i++)
+  {
+    pairs.emplace_back(i % 10000, i);
+  }
+  map.bulkLoad(pairs.begin(), pairs.end());
+  assert(map.size() == 10000);
+  assert(map.find(1)->second == 20001);
+  assert(map.loadFactor() <= 1);
+
+  std::cout << "All bulk load tests passed successfully.\n";
+}
+
+template <class DictionaryType>
+void testFindBatch()
+{
+  DictionaryType dict;
+  for (int i = 0; i < 1000; i += 2)
+  {
+    dict.insert("word" + std::to_string(i), "t" + std::to_string(i));
+  }
+
+  // Test 1: Every key resolves exactly as find() would, across block edges
+  std::vector<std::string> keys;
+  for (int i = 0; i < 203; i++)
+  {
+    keys.push_back("word" + std::to_string(i * 7 % 1000));
+  }
+  std::vector<typename DictionaryType::iterator> found;
+  dict.findBatch(keys.begin(), keys.end(), std::back_inserter(found));
+  assert(found.size() == keys.size());
+  for (std::size_t i = 0; i < keys.size(); i++)
+  {
+    assert(found[i] == dict.find(keys[i]));
+  }
+
+  // Test 2: An empty batch writes nothing
+  found.clear();
+  dict.findBatch(keys.begin(), keys.begin(), std::back_inserter(found));
+  assert(found.empty());
+
+  std::cout << "All findBatch tests passed successfully.\n";
+}
+
+void testDictionarySnapshot()
+{
+  const std::string path = (std::filesystem::temp_directory_path() / "hashmap_snapshot_test.bin").string();
+  Dictionary dict;
+  for (int i = 0; i < 3000; i++)
+  {
+    dict.insert("word" + std::to_string(i), "translation" + std::to_string(i % 13));
+    dict.insert("word" + std::to_string(i), "alt" + std::to_string(i % 5));
+  }
+  dict.insert("", "empty key");
+  dict.saveSnapshot(path);
+
+  // Test 1: The mapped snapshot answers exactly like the dictionary
+  {
+    DictionarySnapshot snapshot(path);
+    assert(snapshot.size() == dict.size());
+    for (auto it = dict.begin(); it != dict.end(); ++it)
+    {
+      SnapshotTranslations translations = snapshot.find(it->first);
+      assert(translations.size() == it->second.size());
+      auto expected = it->second.begin();
+      for (std::string_view translation : translations)
+      {
+        assert(translation == *expected);
+        ++expected;
+      }
+    }
+    assert(!snapshot.contains("missing") && snapshot.find("word3000").empty());
+
+    // Test 2: Snapshots can be moved without remapping
+    DictionarySnapshot moved(std::move(snapshot));
+    assert(moved.find("word42")[0] == "alt2");
+  }
+
+  // Test 3: A translation pointing outside the arena is caught by find()
+  {
+    detail::SnapshotHeader header;
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    detail::SnapshotString outside{ header.arenaSize, 1 };
+    file.seekp(static_cast<std::streamoff>(header.stringsOffset));
+    file.write(reinterpret_cast<const char*>(&outside), sizeof(outside));
+  }
+  {
+    DictionarySnapshot snapshot(path);
+    std::size_t corrupted = 0;
+    for (auto it = dict.begin(); it != dict.end(); ++it)
+    {
+      try
+      {
+        snapshot.find(it->first);
+      }
+      catch (const std::runtime_error&)
+      {
+        ++corrupted;
+      }
+    }
+    assert(corrupted == 1);
+  }
+
+  // Test 4: A truncated file is rejected when opened
+  std::filesystem::resize_file(path, 40);
+  bool rejected = false;
+  try
+  {
+    DictionarySnapshot broken(path);
+  }
+  catch (const std::runtime_error&)
+  {
+    rejected = true;
+  }
+  assert(rejected);
+  std::filesystem::remove(path);
+
+  std::cout << "All DictionarySnapshot tests passed successfully.\n";
+}
+
+void testDictionaryParser()
+{
+  std::string text = "hello -   привет\nworld - мир\n\nno dash here\ntrailing -\n"
+    "  spaced   -  word  \nminus - a-b\nlast - без перевода строки";
+  std::vector<std::pair<std::string, std::string>> entries;
+  std::vector<std::string> errors;
+  auto onEntry = [&entries](std::string_view word, std::string_view translation)
+  {
+    entries.emplace_back(std::string(word), std::string(translation));
+  };
+  auto onError = [&errors](std::string_view line) { errors.emplace_back(line); };
+
+  // Test 1: Words lose trailing spaces, translations lose leading spaces
+  ParseStats stats = parseDictionaryText(text, onEntry, onError);
+  assert(stats.lines == 8 && stats.entries == 5 && stats.malformed == 3);
+  assert(stats.bytes == text.size());
+  assert(entries[0].first == "hello" && entries[0].second == "привет");
+  assert(entries[2].first == "  spaced" && entries[2].second == "word  ");
+  assert(entries[3].first == "minus" && entries[3].second == "a-b");
+  assert(entries[4].first == "last" && entries[4].second == "без перевода строки");
+
+  // Test 2: Malformed lines are reported verbatim
+  assert(errors.size() == 3);
+  assert(errors[0].empty() && errors[1] == "no dash here" && errors[2] == "trailing -");
+
+  // Test 3: Reading the file in blocks smaller than a line gives the same result
+  const std::string path = (std::filesystem::temp_directory_path() / "hashmap_parser_test.txt").string();
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+  }
+  auto expectedEntries = entries;
+  auto expectedErrors = errors;
+  for (std::size_t blockSize : { std::size_t(1), std::size_t(8), std::size_t(17), detail::PARSE_BLOCK_SIZE })
+  {
+    entries.clear();
+    errors.clear();
+    stats = parseDictionaryFile(path, onEntry, onError, blockSize);
+    assert(stats.lines == 8 && stats.bytes == text.size());
+    assert(entries == expectedEntries && errors == expectedErrors);
+  }
+  std::filesystem::remove(path);
+
+  // Test 4: A missing file is reported by an exception
+  bool rejected = false;
+  try
+  {
+    parseDictionaryFile(path, onEntry, onError);
+  }
+  catch (const std::runtime_error&)
+  {
+    rejected = true;
+  }
+  assert(rejected);
+
+  std::cout << "All DictionaryParser tests passed successfully.\n";
+}
+
+template <class DictionaryType>
+void testTransparentLookup()
+{
+  DictionaryType dict;
+  for (int i = 0; i < 500; i++)
+  {
+    dict.insert("a rather long word number " + std::to_string(i), "t" + std::to_string(i));
+  }
+  dict.insert("word", "слово");
+  dict.insert("word", "речь");
+
+  // Test 1: string_view keys reach find() directly; std::string has no
+  // implicit constructor from string_view, so no temporary Key is built
+  std::string buffer = "GET a rather long word number 123 HTTP";
+  std::string_view word = std::string_view(buffer).substr(4, 29);
+  auto found = dict.find(word);
+  assert(found != dict.end() && found->second.front() == "t123");
+  assert(dict.find(std::string_view(buffer)) == dict.end());
+  assert(dict.find("word")->second.size() == 2);
+
+  // Test 2: string_view keys work for findBatch and removal
+  std::vector<std::string_view> keys = { word, "word", "missing" };
+  std::vector<typename DictionaryType::iterator> results;
+  dict.findBatch(keys.begin(), keys.end(), std::back_inserter(results));
+  assert(results[0] == found && results[1] == dict.find("word") && results[2] == dict.end());
+
+  dict.remove(std::string_view("word"), std::string_view("речь"));
+  assert(dict.find("word")->second.size() == 1);
+  dict.remove(word, "t123");
+  assert(dict.find(word) == dict.end());
+  assert(dict.BaseType::remove(std::string_view("word")));
+  assert(!dict.BaseType::remove(std::string_view("word")));
+  assert(dict.size() == 499);
+
+  // Test 3: Words and translations can be inserted and bulk loaded straight
+  // from views into a larger text
+  std::string text = "cat - кот\ndog - пёс\ncat - кошка";
+  dict.insert(std::string_view(text).substr(0, 3), std::string_view(text).substr(6, 6));
+  dict.insert(std::string_view(text).substr(0, 3), std::string_view(text).substr(6, 6));
+  assert(dict.find("cat")->second.size() == 1 && dict.find("cat")->second.front() == "кот");
+  std::vector<std::pair<std::string_view, std::string_view>> views = {
+    { std::string_view(text).substr(13, 3), std::string_view(text).substr(19, 6) },
+    { std::string_view(text).substr(26, 3), std::string_view(text).substr(32) },
+    { std::string_view(text).substr(0, 3), std::string_view(text).substr(6, 6) } };
+  dict.bulkLoad(views.begin(), views.end());
+  assert(dict.find("dog")->second.front() == "пёс" && dict.find("cat")->second.size() == 2);
+  assert(dict.size() == 501);
+
+  std::cout << "All transparent lookup tests passed successfully.\n";
+}
+
+void testSmallSortedSet()
+{
+  SmallSortedSet<std::string, 4> set;
+
+  // Test 1: Values stay sorted and unique, inline up to four of them
+  assert(set.insert("delta") && set.insert("bravo") && set.insert("charlie"));
+  assert(!set.insert("bravo"));
+  assert(set.insert("alpha"));
+  assert(set.size() == 4 && set.isInline());
+  assert(set[0] == "alpha" && set[3] == "delta");
+
+  // Test 2: Growing past the inline buffer moves everything to the heap
+  for (int i = 0; i < 100; i++)
+  {
+    set.insert("a translation long enough to need its own allocation " + std::to_string(i * 37 % 100));
+  }
+  assert(set.size() == 104 && !set.isInline());
+  for (auto it = set.begin(); it + 1 != set.end(); ++it)
+  {
+    assert(*it < *(it + 1));
+  }
+
+  // Test 3: Removal and lookup by string_view
+  assert(set.remove(std::string_view("charlie")) && !set.remove(std::string_view("charlie")));
+  assert(set.contains(std::string_view("delta")) && !set.contains(std::string_view("charlie")));
+  assert(set.find("echo") == set.end());
+  assert(set.size() == 103);
+
+  // Test 4: Copies and moves, from both the inline and the heap state
+  SmallSortedSet<std::string, 4> copy(set);
+  assert(copy.size() == set.size() && std::equal(copy.begin(), copy.end(), set.begin()));
+  SmallSortedSet<std::string, 4> moved(std::move(copy));
+  assert(moved.size() == 103 && copy.empty() && copy.isInline());
+
+  SmallSortedSet<std::string, 4> small;
+  small.insert("one");
+  small.insert("two");
+  moved = small;
+  assert(moved.size() == 2 && moved.isInline() && small.size() == 2);
+  copy = std::move(set);
+  assert(copy.size() == 103 && set.empty());
+  set = std::move(moved);
+  assert(set.size() == 2 && set.front() == "one");
+
+  // Test 5: Clearing returns to the inline buffer
+  copy.clear();
+  assert(copy.empty() && copy.isInline());
+  assert(copy.insert("again") && copy.size() == 1);
+
+  // Test 6: Spilled values go through the given allocator
+  PoolAllocator<int> pool;
+  SmallSortedSet<int, 2, PoolAllocator<int>> pooled(pool);
+  for (int i = 10; i > 0; i--)
+  {
+    pooled.insert(i);
+  }
+  assert(pooled.size() == 10 && pooled.front() == 1 && pooled.getAllocator() == pool);
+  SmallSortedSet<int, 2, PoolAllocator<int>> pooledCopy;
+  pooledCopy = pooled;
+  assert(pooledCopy.size() == 10 && pooledCopy.getAllocator() == pool);
+
+  std::cout << "All SmallSortedSet tests passed successfully.\n";
+}
+
+void testStringPool()
+{
+  StringPool pool;
+
+  // Test 1: Equal strings share one id, distinct strings get dense ids
+  StringId hello = pool.intern("hello");
+  assert(pool.intern(std::string("hello")) == hello);
+  assert(pool.intern("") != hello && pool.intern("") == pool.intern(std::string_view()));
+  assert(pool.size() == 2 && pool.view(hello) == "hello" && pool.view(1).empty());
+
+  // Test 2: Views stay valid while the arena and the index grow
+  std::string_view first = pool.view(hello);
+  std::string large(100000, 'x');
+  StringId largeId = pool.intern(large);
+  for (int i = 0; i < 20000; i++)
+  {
+    assert(pool.intern("string" + std::to_string(i)) == static_cast<StringId>(i + 3));
+  }
+  assert(first.data() == pool.view(hello).data() && pool.view(largeId) == large);
+  for (int i = 0; i < 20000; i += 97)
+  {
+    StringId id = detail::NO_STRING_ID;
+    assert(pool.find("string" + std::to_string(i), id) && id == static_cast<StringId>(i + 3));
+  }
+
+  // Test 3: find never adds, clear forgets everything
+  StringId id;
+  assert(!pool.find("missing", id) && pool.size() == 20003);
+  StringPool moved(std::move(pool));
+  assert(moved.size() == 20003 && pool.empty());
+  moved.clear();
+  assert(moved.empty() && !moved.find("hello", id) && moved.intern("hello") == 0);
+
+  std::cout << "All StringPool tests passed successfully.\n";
+}
+
+void testInternedDictionary()
+{
+  InternedDictionary interned;
+  Dictionary dict;
+  for (int i = 0; i < 5000; i++)
+  {
+    std::string word = "word" + std::to_string(i % 2000);
+    std::string translation = "translation" + std::to_string(i * 7 % 300);
+    interned.insert(word, translation);
+    dict.insert(word, translation);
+  }
+
+  // Test 1: Same contents as Dictionary, with every string stored once
+  assert(interned.size() == dict.size());
+  assert(interned.strings().size() == 2000 + 300);
+  for (auto it = dict.begin(); it != dict.end(); ++it)
+  {
+    InternedTranslations translations = interned.find(it->first);
+    assert(translations.size() == it->second.size());
+    for (std::string_view translation : translations)
+    {
+      assert(it->second.contains(translation));
+    }
+  }
+  assert(!interned.contains("missing") && interned.find("missing").empty());
+
+  // Test 2: Removal by unknown strings does not grow the pool
+  interned.remove("unknown word", "unknown translation");
+  assert(interned.strings().size() == 2300);
+  std::string_view removed = interned.find("word7")[0];
+  std::size_t count = interned.find("word7").size();
+  interned.remove("word7", removed);
+  assert(interned.find("word7").size() == count - 1);
+  while (!interned.find("word7").empty())
+  {
+    interned.remove("word7", interned.find("word7")[0]);
+  }
+  assert(!interned.contains("word7") && interned.size() == 1999);
+  for (auto it = dict.begin(); it != dict.end(); ++it)
+  {
+    assert(it->first == "word7" || interned.find(it->first).size() == it->second.size());
+  }
+  assert(!interned.contains("translation0"));
+
+  // Test 3: forEach visits every word once
+  std::size_t words = 0;
+  std::size_t pairs = 0;
+  interned.forEach([&words, &pairs](std::string_view, const InternedTranslations& translations)
+  {
+    ++words;
+    pairs += translations.size();
+  });
+  assert(words == 1999 && pairs > words);
+
+  interned.clear();
+  assert(interned.empty() && interned.strings().empty());
+
+  std::cout << "All InternedDictionary tests passed successfully.\n";
+}
+
+void testVersionedDictionary()
+{
+  DictionaryEditor editor;
+
+  // Test 1: Edits are visible to the editor and frozen by commit()
+  editor.insert("hello", "привет");
+  editor.insert("world", "мир");
+  editor.insert("world", "земля");
+  assert(editor.version().size() == 2);
+  std::shared_ptr<const DictionaryVersion> first = editor.commit();
+  assert(first->size() == 2 && first->find("world")->size() == 2);
+  assert(first->find("missing") == nullptr);
+
+  // Test 2: A later version leaves the earlier one alone and shares every
+  // segment it did not touch
+  editor.remove("world", "земля");
+  editor.remove("hello", "привет");
+  assert(!editor.remove("hello"));
+  editor.insert("new", "новый");
+  std::shared_ptr<const DictionaryVersion> second = editor.commit();
+  assert(first->size() == 2 && first->find("world")->size() == 2 && !first->contains("new"));
+  assert(second->size() == 2 && second->find("world")->size() == 1 && !second->contains("hello"));
+  assert(second->sharedSegments(*first) + 3 >= second->segmentCount());
+
+  editor.insert("new", "новый");
+  assert(editor.commit() == second);
+
+  // Test 3: Growing the directory keeps every word and every old version
+  for (int i = 0; i < 5000; i++)
+  {
+    editor.insert("word" + std::to_string(i), "translation" + std::to_string(i % 7));
+  }
+  std::shared_ptr<const DictionaryVersion> third = editor.commit();
+  assert(third->size() == 5002 && third->segmentCount() > second->segmentCount());
+  std::size_t count = 0;
+  third->forEach([&count](std::string_view word, const DictionaryVersion::TranslationList& translations)
+  {
+    assert(!translations.empty() && (word.substr(0, 4) != "word" || translations.size() == 1));
+    ++count;
+  });
+  assert(count == 5002 && second->size() == 2 && second->segmentCount() == first->segmentCount());
+
+  // Test 4: A grow splits one segment and leaves the rest shared
+  std::size_t inserted = 0;
+  while (editor.version().segmentCount() == third->segmentCount())
+  {
+    editor.insert("grow" + std::to_string(inserted++), "рост");
+  }
+  assert(editor.version().segmentCount() == third->segmentCount() + 1);
+  assert(editor.version().sharedSegments(*third) + inserted >= third->segmentCount());
+  assert(third->size() == 5002 && !third->contains("grow0") && editor.version().contains("grow0"));
+
+  editor.remove("word42");
+  editor.clear();
+  assert(editor.version().empty() && third->contains("word42"));
+
+  // Test 5: Readers never see half of an update, however long they keep a
+  // snapshot
+  VersionedDictionary dict;
+  const int wordCount = 500;
+  dict.update([wordCount](DictionaryEditor& edit)
+  {
+    for (int i = 0; i < wordCount; i++)
+    {
+      edit.insert("word" + std::to_string(i), "round0");
+    }
+  });
+
+  std::atomic<bool> done(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; t++)
+  {
+    readers.emplace_back([&dict, &done, wordCount]()
+    {
+      while (!done.load())
+      {
+        std::shared_ptr<const DictionaryVersion> version = dict.snapshot();
+        std::string round = version->find("word0")->front();
+        for (int i = 0; i < wordCount; i += 3)
+        {
+          const DictionaryVersion::TranslationList* translations = version->find("word" + std::to_string(i));
+          assert(translations != nullptr && translations->size() == 1 && translations->front() == round);
+        }
+      }
+    });
+  }
+
+  for (int round = 1; round <= 50; round++)
+  {
+    dict.update([wordCount, round](DictionaryEditor& edit)
+    {
+      for (int i = 0; i < wordCount; i++)
+      {
+        std::string word = "word" + std::to_string(i);
+        edit.remove(word);
+        edit.insert(word, "round" + std::to_string(round));
+      }
+    });
+  }
+  done.store(true);
+  for (std::thread& reader : readers)
+  {
+    reader.join();
+  }
+  assert(dict.snapshot()->find("word7")->front() == "round50");
+
+  std::cout << "All VersionedDictionary tests passed successfully.\n";
+}
+
+void testStaticDictionary()
+{
+  // Test 1: The table generated by the build from tests/StaticWords.txt
+  assert(staticTestWords.size() == 12);
+  auto it = staticTestWords.find("world");
+  assert(it != staticTestWords.end() && it->first == "world");
+  assert(it->second.size() == 2 && it->second[0] == "земля" && it->second[1] == "мир");
+  assert(staticTestWords.find("say \"hi\"")->second[0] == "сказать \"привет\"");
+  assert(staticTestWords.contains("back\\slash") && staticTestWords.contains("tab\tinside"));
+  assert(staticTestWords.find("привет")->second[0] == "hello");
+  assert(!staticTestWords.contains("missing") && !staticTestWords.contains("") && !staticTestWords.contains("worl"));
+  assert(std::distance(staticTestWords.begin(), staticTestWords.end()) == 12);
+
+  // Test 2: Tables built at run time find every word and reject every miss
+  StaticDictionaryBuilder builder;
+  const int wordCount = 100000;
+  for (int i = 0; i < wordCount; i++)
+  {
+    builder.insert("word" + std::to_string(i), "translation" + std::to_string(i % 13));
+    if (i % 10 == 0)
+    {
+      builder.insert("word" + std::to_string(i), "extra");
+    }
+  }
+  StaticDictionary dict = builder.build();
+  assert(dict.size() == wordCount);
+  for (int i = 0; i < wordCount; i++)
+  {
+    std::string word = "word" + std::to_string(i);
+    auto found = dict.find(word);
+    assert(found != dict.end() && found->first == word);
+    assert(found->second.size() == (i % 10 == 0 ? 2u : 1u));
+    assert(std::find(found->second.begin(), found->second.end(), "translation" + std::to_string(i % 13)) != found->second.end());
+    assert(!dict.contains("word" + std::to_string(wordCount + i)));
+  }
+
+  std::size_t translations = 0;
+  for (const auto& entry : dict)
+  {
+    translations += entry.second.size();
+  }
+  assert(translations == wordCount + wordCount / 10);
+
+  // Test 3: No words
+  StaticDictionaryBuilder emptyBuilder;
+  StaticDictionary empty = emptyBuilder.build();
+  assert(empty.empty() && empty.find("word") == empty.end() && empty.begin() == empty.end());
+
+  std::cout << "All StaticDictionary tests passed successfully.\n";
+}
+
+#if defined(HASHMAP_ENABLE_STATS)
+struct ConstantHash
+{
+  std::size_t operator()(int) const
+  {
+    return 42;
+  }
+};
+
+template <class Storage>
+void testHashMapStats()
+{
+  constexpr bool CHAINED = std::is_same_v<Storage, detail::ChainedStorage>;
+  constexpr bool FLAT = std::is_same_v<Storage, detail::FlatStorage>;
+  BasicDictionary<Storage> dict;
+  for (int i = 0; i < 1000; i++)
+  {
+    dict.insert("a word long enough to live on the heap " + std::to_string(i), "t" + std::to_string(i));
+  }
+
+  // Test 1: the histogram accounts for every bucket (chained) or entry (flat)
+  HashMapStats stats = dict.stats();
+  std::size_t counted = 0;
+  std::size_t entries = 0;
+  for (std::size_t length = 0; length < detail::STATS_HISTOGRAM_SIZE; length++)
+  {
+    counted += stats.lengthHistogram[length];
+    entries += length * stats.lengthHistogram[length];
+  }
+  assert(stats.size == 1000);
+  assert(counted == (CHAINED ? stats.bucketCount : stats.size));
+  assert(!CHAINED || entries == stats.size);
+  assert(!CHAINED || stats.emptyBuckets == stats.lengthHistogram[0]);
+  assert(stats.emptyBuckets > 0 && stats.emptyBuckets < stats.bucketCount);
+  assert(stats.maxLength < detail::STATS_HISTOGRAM_SIZE && stats.lengthHistogram[stats.maxLength] > 0);
+
+  // Test 2: memory covers buckets, nodes and the strings of keys and values
+  assert(stats.bucketBytes >= stats.bucketCount * sizeof(void*));
+  if constexpr (CHAINED)
+  {
+    assert(stats.nodeBytes == stats.size * sizeof(typename BasicDictionary<Storage>::NodeType));
+  }
+  else if constexpr (FLAT)
+  {
+    assert(stats.nodeBytes == 0);
+  }
+  else
+  {
+    assert(stats.nodeBytes >= stats.size * sizeof(typename BasicDictionary<Storage>::PairType));
+  }
+  assert(stats.elementBytes > stats.size * 40);
+  assert(stats.totalBytes() == stats.bucketBytes + stats.nodeBytes + stats.elementBytes);
+
+  // Test 3: growth and explicit rehashes are counted and timed
+  assert(stats.rehashCount > 0 && stats.rehashSeconds > 0);
+  dict.rehash(stats.bucketCount * 4);
+  HashMapStats after = dict.stats();
+  assert(after.rehashCount == stats.rehashCount + 1 && after.rehashSeconds >= stats.rehashSeconds);
+  assert(after.bucketCount >= stats.bucketCount * 4);
+
+  // Test 4: colliding keys show up as one long chain or probe sequence; dense
+  // storage probes one slot at a time, so most of them land in the last cell
+  HashMap<int, int, ConstantHash, Storage> collisions(64);
+  for (int i = 0; i < 40; i++)
+  {
+    collisions.insert(i, i);
+  }
+  HashMapStats collided = collisions.stats();
+  assert(collided.rehashCount == 0);
+  assert(collided.maxLength == (CHAINED ? 40 : FLAT ? (40 - 1) / detail::Group::WIDTH : 40 - 1));
+  assert(collided.lengthHistogram[detail::STATS_HISTOGRAM_SIZE - 1]
+    == (CHAINED ? 1 : FLAT ? 0 : 40 - (detail::STATS_HISTOGRAM_SIZE - 1)));
+
+  std::cout << "All HashMapStats tests passed successfully.\n";
+}
+#endif
+
+namespace
+{
+  struct TestCase
+  {
+    const char* name;
+    void (*run)();
+  };
+
+  const TestCase TESTS[] = {
+    { "Dictionary", testDictionary<Dictionary> },
+    { "FlatDictionary", testDictionary<FlatDictionary> },
+    { "DenseDictionary", testDictionary<DenseDictionary> },
+    { "PooledDictionary", testDictionary<PooledDictionary> },
+    { "FlatHashMap", testFlatHashMap },
+    { "DenseHashMap", testDenseHashMap },
+    { "IncrementalRehash", testIncrementalRehash },
+    { "PoolAllocator", testPoolAllocator },
+    { "EmplaceChained", testEmplace<detail::ChainedStorage> },
+    { "EmplaceFlat", testEmplace<detail::FlatStorage> },
+    { "EmplaceDense", testEmplace<detail::DenseStorage> },
+    { "ShrinkChained", testShrink<detail::ChainedStorage> },
+    { "ShrinkIncremental", testShrink<detail::ChainedStorage, true> },
+    { "ShrinkFlat", testShrink<detail::FlatStorage> },
+    { "ShrinkDense", testShrink<detail::DenseStorage> },
+    { "SortedUniqueList", testSortedUniqueList },
+    { "SmallSortedSet", testSmallSortedSet },
+    { "StringHash", testStringHash },
+    { "CachedHash", testCachedHash },
+    { "ConcurrentHashMapChained", testConcurrentHashMap<detail::ChainedStorage> },
+    { "ConcurrentHashMapFlat", testConcurrentHashMap<detail::FlatStorage> },
+    { "ReadMostlyHashMap", testReadMostlyHashMap },
+    { "BulkLoad", testBulkLoad<Dictionary> },
+    { "BulkLoadFlat", testBulkLoad<FlatDictionary> },
+    { "BulkLoadDense", testBulkLoad<DenseDictionary> },
+    { "BulkLoadPooled", testBulkLoad<PooledDictionary> },
+    { "FindBatch", testFindBatch<Dictionary> },
+    { "FindBatchFlat", testFindBatch<FlatDictionary> },
+    { "FindBatchDense", testFindBatch<DenseDictionary> },
+    { "DictionarySnapshot", testDictionarySnapshot },
+    { "DictionaryParser", testDictionaryParser },
+    { "TransparentLookup", testTransparentLookup<Dictionary> },
+    { "TransparentLookupFlat", testTransparentLookup<FlatDictionary> },
+    { "TransparentLookupDense", testTransparentLookup<DenseDictionary> },
+    { "StringPool", testStringPool },
+    { "InternedDictionary", testInternedDictionary },
+    { "VersionedDictionary", testVersionedDictionary },
+    { "StaticDictionary", testStaticDictionary },
+#if defined(HASHMAP_ENABLE_STATS)
+    { "HashMapStats", testHashMapStats<detail::ChainedStorage> },
+    { "HashMapStatsFlat", testHashMapStats<detail::FlatStorage> },
+    { "HashMapStatsDense", testHashMapStats<detail::DenseStorage> },
+#endif
+  };
+}
+
+// Runs the tests named on the command line, or every test without arguments.
+int main(int argc, char** argv)
+{
+  int run = 0;
+  for (const TestCase& test : TESTS)
+  {
+    bool selected = argc == 1;
+    for (int i = 1; i < argc && !selected; i++)
+    {
+      selected = std::string_view(argv[i]) == test.name;
+    }
+    if (selected)
+    {
+      test.run();
+      ++run;
+    }
+  }
+
+  if (run == 0)
+  {
+    std::cerr << "No test matches the given names.\n";
+    return 1;
+  }
+  std::cout << "Tests completed.\n";
+  return 0;
+}
@@ -0,0 +1,90 @@
+// Turns a "word - translation" list into a StaticDictionary: writes
+// <name>.h, declaring `extern const StaticDictionary <name>`, and <name>.cpp,
+// defining it over constant tables. Normally run by the build through
+// hashmap_add_static_dictionary() in CMakeLists.txt.
+//
+//   static_dictionary_gen words.txt commonWords build/generated
+//
+// The tables store hashes computed on this machine, so the program using them
+// must share its byte order.
+
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+#include "../include/DictionaryParser.h"
+#include "../include/StaticDictionary.h"
+
+namespace
+{
+  bool isIdentifier(const std::string& name)
+  {
+    if (name.empty() || std::isdigit(static_cast<unsigned char>(name[0])))
+    {
+      return false;
+    }
+    for (char c : name)
+    {
+      if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_')
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, char** argv)
+{
+  if (argc != 4 || !isIdentifier(argv[2]))
+  {
+    std::fprintf(stderr, "usage: static_dictionary_gen <word list> <identifier> <output directory>\n");
+    return 2;
+  }
+  const std::string input = argv[1];
+  const std::string name = argv[2];
+  const std::filesystem::path outputDirectory = argv[3];
+
+  StaticDictionaryBuilder builder;
+  std::size_t malformed = 0;
+  try
+  {
+    parseDictionaryFile(input,
+      [&builder](std::string_view word, std::string_view translation)
+      {
+        builder.insert(std::string(word), std::string(translation));
+      },
+      [&malformed, &input](std::string_view line)
+      {
+        std::fprintf(stderr, "%s: malformed line '%.*s'\n", input.c_str(), static_cast<int>(line.size()), line.data());
+        ++malformed;
+      });
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  if (malformed != 0)
+  {
+    return 1;
+  }
+
+  StaticDictionary dictionary = builder.build();
+  std::filesystem::create_directories(outputDirectory);
+  std::ofstream header(outputDirectory / (name + ".h"), std::ios::binary);
+  std::ofstream source(outputDirectory / (name + ".cpp"), std::ios::binary);
+  builder.writeHeader(header, name);
+  builder.writeSource(source, name);
+  if (!header.flush() || !source.flush())
+  {
+    std::fprintf(stderr, "Could not write %s to '%s'.\n", name.c_str(), outputDirectory.string().c_str());
+    return 1;
+  }
+
+  std::printf("%s: %zu words\n", name.c_str(), dictionary.size());
+  return 0;
+}